@@ -0,0 +1,117 @@
+#include "AllocationGuard.h"
+
+#include <atomic>
+
+#ifndef ALLOCATION_GUARD
+
+bool AllocationGuardEnabled() { return false; }
+void SetAllocationAbort(bool) {}
+uint64_t RealtimeAllocations() { return 0; }
+
+#else
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+
+namespace {
+constexpr uint64_t kMaxReports = 16; // backtraces printed; later calls are only counted
+
+// Constant-initialized, so reading them from inside the allocator is safe
+// even while a thread is being set up
+thread_local int realtimeDepth = 0;
+thread_local bool reporting = false;
+std::atomic<uint64_t> violations{0};
+std::atomic<bool> abortOnAllocation{false};
+
+void Check(const char* what, size_t size) {
+    if (realtimeDepth == 0 || reporting) return;
+    reporting = true; // the report itself may allocate
+    uint64_t n = violations.fetch_add(1, std::memory_order_relaxed) + 1;
+    bool abort = abortOnAllocation.load(std::memory_order_relaxed);
+    if (n <= kMaxReports || abort) {
+        std::fprintf(stderr, "allocation guard: %s(%zu) on the audio path\n", what, size);
+#if defined(__GLIBC__)
+        void* frames[32];
+        backtrace_symbols_fd(frames, backtrace(frames, 32), 2);
+#endif
+    }
+    if (abort) std::abort();
+    reporting = false;
+}
+}
+
+RealtimeScope::RealtimeScope() { ++realtimeDepth; }
+RealtimeScope::~RealtimeScope() { --realtimeDepth; }
+
+bool AllocationGuardEnabled() { return true; }
+void SetAllocationAbort(bool abort) { abortOnAllocation = abort; }
+uint64_t RealtimeAllocations() { return violations.load(std::memory_order_relaxed); }
+
+#if defined(__GLIBC__)
+// Interposes glibc's allocator; operator new and delete end up here too
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* p);
+
+void* malloc(size_t size) {
+    Check("malloc", size);
+    return __libc_malloc(size);
+}
+void* calloc(size_t count, size_t size) {
+    Check("calloc", count * size);
+    return __libc_calloc(count, size);
+}
+void* realloc(void* p, size_t size) {
+    Check("realloc", size);
+    return __libc_realloc(p, size);
+}
+void* aligned_alloc(size_t alignment, size_t size) {
+    Check("aligned_alloc", size);
+    return __libc_memalign(alignment, size);
+}
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    Check("posix_memalign", size);
+    if (alignment % sizeof(void*) || (alignment & (alignment - 1))) return 22; // EINVAL
+    void* p = __libc_memalign(alignment, size);
+    if (!p && size) return 12; // ENOMEM
+    *out = p;
+    return 0;
+}
+void free(void* p) {
+    if (p) Check("free", 0);
+    __libc_free(p);
+}
+}
+#else
+// Elsewhere the C++ allocation functions are replaced
+void* operator new(size_t size) {
+    Check("operator new", size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    Check("operator new", size);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept {
+    if (p) Check("operator delete", 0);
+    std::free(p);
+}
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+#endif
+
+#endif
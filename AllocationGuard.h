@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// Debug check that the audio path never touches the heap. Configured with
+// -DALLOCATION_GUARD=ON, the build replaces the allocator entry points (the
+// malloc family on glibc, operator new/delete elsewhere); a call made while
+// the thread is inside a RealtimeScope is counted and reported with a
+// backtrace on stderr, or aborts the process when abort is set. Without the
+// option the scope is empty and the counter stays 0.
+class RealtimeScope {
+public:
+#ifdef ALLOCATION_GUARD
+    RealtimeScope();
+    ~RealtimeScope();
+#else
+    RealtimeScope() {}
+#endif
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+};
+
+bool AllocationGuardEnabled();
+void SetAllocationAbort(bool abort);
+// Allocations and frees seen inside a RealtimeScope so far
+uint64_t RealtimeAllocations();
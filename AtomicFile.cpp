@@ -0,0 +1,53 @@
+#include "AtomicFile.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static bool Fail(std::string* error, const std::string& msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+bool WriteFileAtomic(const std::string& path, const std::string& data, std::string* error) {
+    std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return Fail(error, "cannot write " + tmp);
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = ok && std::fflush(f) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        return Fail(error, "write failed for " + tmp);
+    }
+#ifdef _WIN32
+    if (!MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        return Fail(error, "cannot rename " + tmp);
+    }
+#else
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        return Fail(error, "cannot rename " + tmp);
+    }
+    // Persist the rename itself
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    int dfd = ::open(dir.c_str(), O_RDONLY);
+    if (dfd >= 0) {
+        fsync(dfd);
+        ::close(dfd);
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// Writes data to path.tmp, flushes it to disk and renames it over path, so
+// readers see either the old or the new file and never a partial one
+bool WriteFileAtomic(const std::string& path, const std::string& data, std::string* error = nullptr);
@@ -0,0 +1,327 @@
+#include "AudioOutput.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+constexpr int kStartTimeoutMs = 1000; // for a new stream's first callback, and a handover
+
+template <typename Done>
+bool WaitUntil(Done done, int ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+}
+
+AudioOutput::AudioOutput(float sampleRate, RenderFn render, ThreadFn threadSetup)
+    : sampleRate_(sampleRate),
+      fadeFrames_(std::max(1u, (unsigned int)(kFadeMs * sampleRate / 1000.0f))),
+      render_(render),
+      threadSetup_(threadSetup),
+      handover_(new float[kHandoverFrames * kMaxChannels]()) {
+    thread_ = std::thread([this] { Run(); });
+}
+
+AudioOutput::~AudioOutput() { Close(); }
+
+void AudioOutput::Open(const Settings& settings) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    request_ = settings;
+    pending_ = true;
+    switching_ = true;
+    cv_.notify_one();
+}
+
+void AudioOutput::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+        cv_.notify_one();
+    }
+    if (thread_.joinable()) thread_.join();
+}
+
+bool AudioOutput::running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+unsigned int AudioOutput::channels() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return channels_;
+}
+
+AudioOutput::Settings AudioOutput::settings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_;
+}
+
+std::vector<AudioOutput::Device> AudioOutput::devices() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return devices_;
+}
+
+std::string AudioOutput::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (latency_ <= 0 || rate_ == 0) return status_;
+    long frames = latency_ + processingLatency_.load(std::memory_order_relaxed);
+    char text[48];
+    snprintf(text, sizeof(text), ", %.1f ms output latency", 1000.0 * frames / rate_);
+    return status_ + text;
+}
+
+int AudioOutput::Callback(void* out, void*, unsigned int frames, double, RtAudioStreamStatus, void* user) {
+    Stream* stream = static_cast<Stream*>(user);
+    stream->output->Process(*stream, static_cast<float*>(out), frames);
+    return 0;
+}
+
+void AudioOutput::Process(Stream& s, float* out, unsigned int frames) {
+    if (!s.setUp) {
+        if (threadSetup_) threadSetup_();
+        s.setUp = true;
+        s.started.store(true, std::memory_order_release);
+    }
+    unsigned int channels = s.channels;
+
+    if (engine_.load(std::memory_order_acquire) == &s) {
+        if (Stream* next = next_.load(std::memory_order_acquire)) {
+            // Hand over between blocks; from here on this stream fades out
+            // what the new one renders
+            handoverWrite_.store(0, std::memory_order_relaxed);
+            handoverRead_.store(0, std::memory_order_relaxed);
+            handoverChannels_ = next->channels;
+            handing_.store(true, std::memory_order_relaxed);
+            s.fadingOut = true;
+            next_.store(nullptr, std::memory_order_relaxed);
+            engine_.store(next, std::memory_order_release);
+        } else {
+            render_(out, frames, channels);
+            if (handing_.load(std::memory_order_relaxed)) PushHandover(out, frames, channels);
+            bool releasing = release_.load(std::memory_order_acquire);
+            if (s.fadeInPos < fadeFrames_ || releasing) {
+                for (unsigned int i = 0; i < frames; ++i) {
+                    float gain = 1.0f;
+                    if (s.fadeInPos < fadeFrames_) gain = (float)s.fadeInPos++ / fadeFrames_;
+                    if (releasing) gain *= s.fadeOutPos < fadeFrames_ ? 1.0f - (float)s.fadeOutPos++ / fadeFrames_ : 0.0f;
+                    for (unsigned int c = 0; c < channels; ++c) out[c * frames + i] *= gain;
+                }
+            }
+            if (releasing && s.fadeOutPos >= fadeFrames_) {
+                release_.store(false, std::memory_order_relaxed);
+                engine_.store(nullptr, std::memory_order_release);
+                s.silent.store(true, std::memory_order_release);
+            }
+            return;
+        }
+    }
+
+    unsigned int got = 0;
+    if (s.fadingOut && !s.silent.load(std::memory_order_relaxed)) {
+        got = PopHandover(out, frames, channels);
+        for (unsigned int i = 0; i < got; ++i) {
+            float gain = s.fadeOutPos < fadeFrames_ ? 1.0f - (float)s.fadeOutPos++ / fadeFrames_ : 0.0f;
+            for (unsigned int c = 0; c < channels; ++c) out[c * frames + i] *= gain;
+        }
+        if (s.fadeOutPos >= fadeFrames_) {
+            handing_.store(false, std::memory_order_relaxed);
+            s.silent.store(true, std::memory_order_release);
+        }
+    }
+    for (unsigned int c = 0; c < channels; ++c) std::fill(out + c * frames + got, out + (c + 1) * frames, 0.0f);
+}
+
+// The old stream's device may run a little slower or faster; what does not
+// fit is dropped, and a shortfall plays as silence
+void AudioOutput::PushHandover(const float* x, unsigned int frames, unsigned int channels) {
+    uint64_t w = handoverWrite_.load(std::memory_order_relaxed);
+    uint64_t r = handoverRead_.load(std::memory_order_acquire);
+    size_t n = std::min<size_t>(frames, kHandoverFrames - (w - r));
+    for (size_t i = 0; i < n; ++i) {
+        float* slot = &handover_[((w + i) & (kHandoverFrames - 1)) * channels];
+        for (unsigned int c = 0; c < channels; ++c) slot[c] = x[c * frames + i];
+    }
+    handoverWrite_.store(w + n, std::memory_order_release);
+}
+
+// Channels the new stream does not have stay silent
+unsigned int AudioOutput::PopHandover(float* x, unsigned int frames, unsigned int channels) {
+    uint64_t r = handoverRead_.load(std::memory_order_relaxed);
+    uint64_t w = handoverWrite_.load(std::memory_order_acquire);
+    unsigned int n = (unsigned int)std::min<uint64_t>(frames, w - r);
+    unsigned int stride = handoverChannels_;
+    for (unsigned int i = 0; i < n; ++i) {
+        const float* slot = &handover_[((r + i) & (kHandoverFrames - 1)) * stride];
+        for (unsigned int c = 0; c < channels; ++c) x[c * frames + i] = c < stride ? slot[c] : 0.0f;
+    }
+    handoverRead_.store(r + n, std::memory_order_release);
+    return n;
+}
+
+void AudioOutput::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return pending_ || quit_; });
+        if (quit_) break;
+        Settings settings = request_;
+        pending_ = false;
+        lock.unlock();
+        Switch(settings);
+        lock.lock();
+        if (!pending_) switching_ = false;
+    }
+    lock.unlock();
+    if (current_) {
+        Release();
+        current_.reset();
+    }
+}
+
+void AudioOutput::Switch(const Settings& settings) {
+    std::string error;
+    std::unique_ptr<Stream> next = Start(settings, &error);
+    if (!next && current_) {
+        // Some devices open only once: let go of the old stream and retry,
+        // going back to it if that fails too
+        Settings previous = current_->settings;
+        Release();
+        current_.reset();
+        std::string retryError;
+        next = Start(settings, &retryError);
+        if (next) {
+            error.clear();
+        } else if ((next = Start(previous, &retryError))) {
+            error += " (kept the previous device)";
+        }
+    }
+    if (next) HandOver(std::move(next));
+    Publish(settings, error);
+}
+
+std::unique_ptr<AudioOutput::Stream> AudioOutput::Start(const Settings& settings, std::string* error) {
+    auto s = std::make_unique<Stream>();
+    s->output = this;
+    s->settings = settings;
+    unsigned int bufferFrames = settings.bufferFrames;
+    RtAudio::StreamOptions options;
+    options.streamName = "MD Drum Synth";
+    options.numberOfBuffers = settings.periods;
+    options.flags = RTAUDIO_NONINTERLEAVED;
+    if (settings.rtPriority > 0) {
+        options.flags |= RTAUDIO_SCHEDULE_REALTIME;
+        options.priority = settings.rtPriority;
+    }
+    std::string deviceName;
+    try {
+        s->dac = std::make_unique<RtAudio>(settings.api);
+        s->settings.api = s->dac->getCurrentApi();
+        unsigned int count = s->dac->getDeviceCount();
+        for (unsigned int i = 0; i < count; ++i) {
+            RtAudio::DeviceInfo info = s->dac->getDeviceInfo(i);
+            if (info.probed && info.outputChannels > 0) s->devices.push_back({i, info.name, info.outputChannels});
+        }
+        probed_ = s->devices;
+        if (s->devices.empty()) {
+            *error = "No output devices for " + RtAudio::getApiDisplayName(s->settings.api);
+            return nullptr;
+        }
+        // An unknown device id falls back to the API's default output
+        unsigned int id = settings.device >= 0 ? (unsigned int)settings.device : s->dac->getDefaultOutputDevice();
+        auto device = std::find_if(s->devices.begin(), s->devices.end(), [id](const Device& d) { return d.id == id; });
+        if (device == s->devices.end()) device = s->devices.begin();
+        s->settings.device = (int)device->id;
+        deviceName = device->name;
+        s->channels = std::max(1u, std::min({settings.channels, device->outputChannels, kMaxChannels}));
+
+        RtAudio::StreamParameters parameters;
+        parameters.deviceId = device->id;
+        parameters.nChannels = s->channels;
+        parameters.firstChannel = 0;
+        s->dac->openStream(&parameters, nullptr, RTAUDIO_FLOAT32, (unsigned int)sampleRate_, &bufferFrames, &Callback,
+                           s.get(), &options);
+        s->dac->startStream();
+    } catch (const RtAudioError& e) {
+        *error = e.getMessage();
+        if (s->dac) Stop(*s);
+        return nullptr;
+    }
+    if (!WaitUntil([&] { return s->started.load(std::memory_order_acquire); }, kStartTimeoutMs)) {
+        Stop(*s);
+        *error = deviceName + " did not start";
+        return nullptr;
+    }
+
+    // Backends that cannot tell their latency report 0: assume the periods
+    s->rate = s->dac->getStreamSampleRate();
+    s->latency = s->dac->getStreamLatency();
+    if (s->latency <= 0) s->latency = (long)bufferFrames * std::max(2u, options.numberOfBuffers);
+    char text[256];
+    snprintf(text, sizeof(text), "%s, %s: %u channels, %u frames x %u periods at %u Hz", deviceName.c_str(),
+             RtAudio::getApiDisplayName(s->settings.api).c_str(), s->channels, bufferFrames, options.numberOfBuffers,
+             s->rate);
+    s->description = text;
+    return s;
+}
+
+void AudioOutput::HandOver(std::unique_ptr<Stream> next) {
+    Stream* old = current_.get();
+    Stream* incoming = next.get();
+    if (old && engine_.load(std::memory_order_acquire) == old) {
+        next_.store(incoming, std::memory_order_release);
+        if (WaitUntil([&] { return engine_.load(std::memory_order_acquire) == incoming; }, kStartTimeoutMs)) {
+            WaitUntil([&] { return old->silent.load(std::memory_order_acquire); }, (int)kFadeMs + kStartTimeoutMs);
+        } else {
+            // The old device stopped calling back; once stopped it cannot
+            // be rendering, so the engine can move without it
+            Stop(*old);
+            next_.store(nullptr, std::memory_order_relaxed);
+            engine_.store(incoming, std::memory_order_release);
+        }
+    } else {
+        engine_.store(incoming, std::memory_order_release);
+    }
+    if (old) Stop(*old);
+    handing_.store(false, std::memory_order_relaxed);
+    current_ = std::move(next);
+}
+
+// Fades the engine's stream to silence and stops it
+void AudioOutput::Release() {
+    if (engine_.load(std::memory_order_acquire) == current_.get()) {
+        release_.store(true, std::memory_order_release);
+        WaitUntil([&] { return current_->silent.load(std::memory_order_acquire); }, (int)kFadeMs + kStartTimeoutMs);
+    }
+    Stop(*current_);
+    release_.store(false, std::memory_order_relaxed);
+    if (engine_.load(std::memory_order_relaxed) == current_.get()) engine_.store(nullptr, std::memory_order_release);
+}
+
+void AudioOutput::Publish(const Settings& requested, const std::string& error) {
+    if (!error.empty()) std::cerr << error << "\n";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = current_ != nullptr;
+        channels_ = current_ ? current_->channels : 0;
+        active_ = current_ ? current_->settings : requested;
+        devices_ = current_ ? current_->devices : probed_;
+        status_ = error.empty() && current_ ? current_->description : error;
+        latency_ = error.empty() && current_ ? current_->latency : 0;
+        rate_ = current_ ? current_->rate : 0;
+    }
+    if (current_ && error.empty()) std::cout << status() << "\n";
+}
+
+void AudioOutput::Stop(Stream& s) {
+    try {
+        if (s.dac->isStreamRunning()) s.dac->stopStream();
+        if (s.dac->isStreamOpen()) s.dac->closeStream();
+    } catch (const RtAudioError& e) {
+        std::cerr << e.getMessage() << "\n";
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <RtAudio.h>
+
+// Owns the audio device. Streams are opened, switched and closed on a
+// background thread, so the GUI never waits on the driver. The new device is
+// opened while the old one keeps playing; once its callback runs, the engine
+// moves over and the two crossfade, the old device playing what the new one
+// renders. A device that cannot be opened alongside the old one (the same
+// device with other settings, say) is opened after the old one fades out.
+// Whatever fails, the previous stream stays or is reopened.
+//
+// The engine is only ever rendered by one stream's callback at a time: the
+// callback that owns it hands it over between two blocks.
+class AudioOutput {
+public:
+    struct Settings {
+        RtAudio::Api api = RtAudio::UNSPECIFIED;
+        int device = -1; // device id within api, -1 for its default output
+        unsigned int bufferFrames = 256;
+        unsigned int periods = 0; // 0: the backend's default
+        int rtPriority = 0;       // asks the backend for a real-time thread
+        unsigned int channels = 2; // wanted; the stream gets as many as the device has
+    };
+    struct Device {
+        unsigned int id;
+        std::string name;
+        unsigned int outputChannels;
+    };
+
+    // Renders one block, on the callback thread owning the engine. The buffer
+    // is non-interleaved: channel c starts at out + c * frames. Backends with
+    // channel-major buffers of their own (JACK, ASIO) take it unconverted.
+    using RenderFn = void (*)(float* out, unsigned int frames, unsigned int channels);
+    // Runs on each stream's callback thread before its first block
+    using ThreadFn = void (*)();
+
+    static constexpr float kFadeMs = 20.0f;
+    static constexpr unsigned int kMaxChannels = 32;
+
+    AudioOutput(float sampleRate, RenderFn render, ThreadFn threadSetup);
+    ~AudioOutput();
+
+    // GUI thread. Open returns at once; a request replaces one that has not
+    // started yet. Close stops everything and waits.
+    void Open(const Settings& settings);
+    void Close();
+    bool switching() const { return switching_.load(std::memory_order_relaxed); }
+    bool running() const;
+    unsigned int channels() const;       // of the running stream, 0 when there is none
+    Settings settings() const;           // of the running stream
+    std::vector<Device> devices() const; // outputs of the running stream's API
+    std::string status() const;          // negotiated stream, or the last error
+    // Frames the render function delays its output by, on top of the
+    // device; any thread. Added to the latency status() reports.
+    void SetProcessingLatency(unsigned int frames) { processingLatency_.store(frames, std::memory_order_relaxed); }
+
+private:
+    struct Stream {
+        AudioOutput* output = nullptr;
+        std::unique_ptr<RtAudio> dac;
+        Settings settings;
+        unsigned int channels = 0; // opened
+        std::vector<Device> devices;
+        std::string description;
+        long latency = 0; // device output latency, frames
+        unsigned int rate = 0;
+        std::atomic<bool> started{false}; // its callback has run
+        std::atomic<bool> silent{false};  // faded out, may be closed
+        // Callback thread only
+        bool setUp = false;
+        bool fadingOut = false; // handed the engine over, plays the handover ring
+        unsigned int fadeInPos = 0;
+        unsigned int fadeOutPos = 0;
+    };
+
+    static int Callback(void* out, void* in, unsigned int frames, double time, RtAudioStreamStatus status, void* user);
+    void Process(Stream& s, float* out, unsigned int frames);
+    void PushHandover(const float* x, unsigned int frames, unsigned int channels);
+    unsigned int PopHandover(float* x, unsigned int frames, unsigned int channels);
+
+    // Switcher thread
+    void Run();
+    void Switch(const Settings& settings);
+    std::unique_ptr<Stream> Start(const Settings& settings, std::string* error);
+    void HandOver(std::unique_ptr<Stream> next);
+    void Release();
+    void Publish(const Settings& requested, const std::string& error);
+    static void Stop(Stream& s);
+
+    float sampleRate_;
+    unsigned int fadeFrames_;
+    RenderFn render_;
+    ThreadFn threadSetup_;
+
+    // Engine ownership; next_ takes over at the owner's next block, and the
+    // owner fades to silence when release_ is set
+    std::atomic<Stream*> engine_{nullptr};
+    std::atomic<Stream*> next_{nullptr};
+    std::atomic<bool> release_{false};
+
+    // Blocks of the new engine stream, for the old one to fade out with;
+    // frames of handoverChannels_ samples
+    static constexpr size_t kHandoverFrames = 4096;
+    std::unique_ptr<float[]> handover_;
+    unsigned int handoverChannels_ = 0; // old stream's callback only
+    std::atomic<bool> handing_{false};
+    alignas(64) std::atomic<uint64_t> handoverWrite_{0};
+    alignas(64) std::atomic<uint64_t> handoverRead_{0};
+
+    // Switcher thread only
+    std::unique_ptr<Stream> current_;
+    std::vector<Device> probed_; // of the API last opened
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_ = false;
+    bool quit_ = false;
+    Settings request_;        // guarded by mutex_
+    Settings active_;         // ditto
+    bool running_ = false;    // ditto
+    unsigned int channels_ = 0; // ditto
+    std::vector<Device> devices_; // ditto
+    std::string status_;      // ditto
+    long latency_ = 0;        // ditto, 0 when there is no stream
+    unsigned int rate_ = 0;   // ditto
+    std::atomic<unsigned int> processingLatency_{0};
+    std::atomic<bool> switching_{false};
+    std::thread thread_;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Whole-frame delay for a set of output channels, to keep outputs that skip
+// a latent processor in time with the ones that go through it. Changing the
+// delay clears the lines, as the processor restarts too. Process runs on the
+// audio thread and never allocates.
+class ChannelDelay {
+public:
+    // Call before the stream starts
+    void Init(size_t channels, size_t maxDelay) {
+        size_ = 1;
+        while (size_ <= maxDelay) size_ <<= 1;
+        maxDelay_ = maxDelay;
+        lines_.assign(channels * size_, 0.0f);
+        positions_.assign(channels, 0);
+        delay_ = 0;
+    }
+
+    // Once per block of all channels, before processing them
+    void SetDelay(size_t delay) {
+        delay = std::min(delay, maxDelay_);
+        if (delay == delay_) return;
+        delay_ = delay;
+        std::fill(lines_.begin(), lines_.end(), 0.0f);
+        std::fill(positions_.begin(), positions_.end(), 0);
+    }
+
+    // In place
+    void Process(size_t channel, float* samples, size_t frames) {
+        if (delay_ == 0 || channel >= positions_.size()) return;
+        float* line = lines_.data() + channel * size_;
+        size_t pos = positions_[channel];
+        const size_t mask = size_ - 1;
+        for (size_t i = 0; i < frames; ++i) {
+            line[pos] = samples[i];
+            samples[i] = line[(pos - delay_) & mask];
+            pos = (pos + 1) & mask;
+        }
+        positions_[channel] = pos;
+    }
+
+private:
+    size_t size_ = 1; // power of two
+    size_t maxDelay_ = 0;
+    size_t delay_ = 0;
+    std::vector<float> lines_;
+    std::vector<size_t> positions_;
+};
@@ -34,7 +34,10 @@ void EndParameters() {
     if (g_SelectedIndex != -1) {
         ParamInfo& param = g_Params[g_SelectedIndex];
 
-        if (param.is_int && param.int_ptr) {
+        if (param.bool_ptr) {
+            if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow, true)) *param.bool_ptr = false;
+            if (ImGui::IsKeyPressed(ImGuiKey_RightArrow, true)) *param.bool_ptr = true;
+        } else if (param.is_int && param.int_ptr) {
             int step = io.KeyShift ? param.int_fast_step : param.int_step;
 
             if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow, true)) {
@@ -60,7 +63,7 @@ void EndParameters() {
     }
 }
 
-void ParameterSlider(const char* label, float* v, float v_min, float v_max, float step, float fast_step) {
+void ParameterSlider(const char* label, float* v, float v_min, float v_max, float step, float fast_step, bool logarithmic) {
     g_Params.push_back({label, v, v_min, v_max, step, fast_step, false});
     int current_index = g_Params.size() - 1;
 
@@ -69,7 +72,7 @@ void ParameterSlider(const char* label, float* v, float v_min, float v_max, floa
         ImGui::PushStyleColor(ImGuiCol_FrameBg, (ImVec4)ImColor::HSV(0.6f, 0.8f, 0.8f));
     }
 
-    ImGui::SliderFloat(label, v, v_min, v_max);
+    ImGui::SliderFloat(label, v, v_min, v_max, "%.3f", logarithmic ? ImGuiSliderFlags_Logarithmic : 0);
 
     if (is_selected) {
         ImGui::PopStyleColor();
@@ -100,4 +103,26 @@ void ParameterSliderInt(const char* label, int* v, int v_min, int v_max, int ste
     }
 }
 
+void ParameterCheckbox(const char* label, bool* v) {
+    ParamInfo info{label, nullptr, 0, 0, 0, 0};
+    info.bool_ptr = v;
+    g_Params.push_back(info);
+    int current_index = g_Params.size() - 1;
+
+    bool is_selected = (g_SelectedIndex == current_index);
+    if (is_selected) {
+        ImGui::PushStyleColor(ImGuiCol_FrameBg, (ImVec4)ImColor::HSV(0.3f, 0.8f, 0.8f));
+    }
+
+    ImGui::Checkbox(label, v);
+
+    if (is_selected) {
+        ImGui::PopStyleColor();
+    }
+
+    if (ImGui::IsItemClicked()) {
+        g_SelectedIndex = current_index;
+    }
+}
+
 }
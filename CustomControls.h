@@ -14,11 +14,13 @@ struct ParamInfo {
     bool is_int = false;
     int* int_ptr = nullptr;
     int int_min = 0, int_max = 0, int_step = 1, int_fast_step = 1;
+    bool* bool_ptr = nullptr;
 };
 
 void BeginParameters();
 void EndParameters();
-void ParameterSlider(const char* label, float* v, float v_min, float v_max, float step = 0.01f, float fast_step = 0.1f);
+void ParameterSlider(const char* label, float* v, float v_min, float v_max, float step = 0.01f, float fast_step = 0.1f, bool logarithmic = false);
 void ParameterSliderInt(const char* label, int* v, int v_min, int v_max, int step = 1, int fast_step = 1);
+void ParameterCheckbox(const char* label, bool* v);
 
 }
@@ -0,0 +1,89 @@
+#include "DrumKit.h"
+
+#include "FmKickModel.h"
+#include "FmSnareModel.h"
+#include "FmTomModel.h"
+#include "FmClapModel.h"
+#include "FmRimshotModel.h"
+#include "FmCowbellModel.h"
+#include "FmCymbalModel.h"
+#include "TRXBassDrum.h"
+#include "TRXSnareDrum.h"
+#include "TRXClaves.h"
+#include "TRXHiHat.h"
+
+template <typename M>
+static std::shared_ptr<DrumModel> Make() {
+    return std::make_shared<M>();
+}
+
+// Track order; it is also the model id used by saved files and kit banks
+static const struct {
+    const char* name;
+    std::shared_ptr<DrumModel> (*create)();
+} kTracks[] = {
+    {"Kick", Make<FmKickModel>},
+    {"Snare", Make<FmSnareModel>},
+    {"Tom", Make<FmTomModel>},
+    {"Clap", Make<FmClapModel>},
+    {"Rimshot", Make<FmRimshotModel>},
+    {"Cowbell", Make<FmCowbellModel>},
+    {"Cymbal", Make<FmCymbalModel>},
+    {"TRX Bass Drum", Make<TRXBassDrum>},
+    {"TRX Snare Drum", Make<TRXSnareDrum>},
+    {"TRX Claves", Make<TRXClaves>},
+    {"TRX HiHat", Make<TRXHiHat>},
+};
+
+size_t TrackCount() {
+    return sizeof(kTracks) / sizeof(kTracks[0]);
+}
+
+const char* TrackName(size_t track) {
+    return track < TrackCount() ? kTracks[track].name : "";
+}
+
+std::shared_ptr<DrumModel> CreateTrackModel(size_t track) {
+    return track < TrackCount() ? kTracks[track].create() : nullptr;
+}
+
+std::unique_ptr<DrumKit> CreateDrumKit() {
+    auto kit = std::make_unique<DrumKit>();
+    for (size_t t = 0; t < TrackCount(); ++t) {
+        kit->models.push_back(kTracks[t].create());
+        kit->models.back()->UpdateCoefficients();
+        kit->models.back()->Init();
+    }
+    kit->voiced.assign(TrackCount(), 0);
+    return kit;
+}
+
+std::unique_ptr<DrumKit> CopyDrumKit(const DrumKit& source) {
+    auto kit = std::make_unique<DrumKit>();
+    for (size_t t = 0; t < TrackCount(); ++t) {
+        kit->models.push_back(kTracks[t].create());
+        DrumModel& model = *kit->models.back();
+        if (t < source.models.size()) {
+            for (size_t id = 0; id < model.getParameterCount(); ++id) model.assignParameter(id, source.models[t]->getParameter(id));
+        }
+        model.UpdateCoefficients();
+        model.Init();
+    }
+    kit->voiced.assign(TrackCount(), 0);
+    kit->generation = source.generation;
+    return kit;
+}
+
+KitExchange::~KitExchange() {
+    CollectRetired();
+    delete staged_.exchange(nullptr);
+}
+
+void KitExchange::Stage(std::unique_ptr<DrumKit> kit) {
+    delete staged_.exchange(kit.release(), std::memory_order_acq_rel);
+}
+
+void KitExchange::CollectRetired() {
+    DrumKit* kit;
+    while (retired_.Pop(kit)) delete kit;
+}
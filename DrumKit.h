@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "DrumModel.h"
+#include "SpscQueue.h"
+
+// One instance of every track model. Kits are replaced as a whole: a new kit
+// is built and initialised off the audio thread, then swapped in.
+struct DrumKit {
+    std::vector<std::shared_ptr<DrumModel>> models;
+    std::vector<char> voiced; // set on a track's first trigger (audio thread)
+    uint32_t generation = 0;  // set when staged; tags parameter changes meant for this kit
+};
+
+size_t TrackCount();
+const char* TrackName(size_t track);
+// Model for one track with its default parameters, not yet initialised
+std::shared_ptr<DrumModel> CreateTrackModel(size_t track);
+// Fresh, initialised models with their default parameters
+std::unique_ptr<DrumKit> CreateDrumKit();
+// Fresh, initialised models with the same parameters as kit
+std::unique_ptr<DrumKit> CopyDrumKit(const DrumKit& kit);
+
+// Lock-free handover of kits between the GUI thread (Stage, CollectRetired)
+// and the audio thread (Acquire, Retire). Kits are never freed on the audio
+// thread: they come back through the retire queue and are deleted here.
+class KitExchange {
+public:
+    ~KitExchange();
+
+    // Replaces any staged kit the audio thread has not picked up yet
+    void Stage(std::unique_ptr<DrumKit> kit);
+    void CollectRetired();
+
+    DrumKit* Acquire() { return staged_.exchange(nullptr, std::memory_order_acq_rel); }
+    bool Pending() const { return staged_.load(std::memory_order_relaxed) != nullptr; }
+    bool Retire(DrumKit* kit) { return retired_.Push(kit); }
+
+private:
+    std::atomic<DrumKit*> staged_{nullptr};
+    SpscQueue<DrumKit*, 16> retired_;
+};
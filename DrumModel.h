@@ -1,6 +1,32 @@
 #pragma once
 
 #include <iostream>
+#include <cmath>
+#include <cstddef>
+
+enum class ParamCurve { Linear, Log };
+
+// Static description of one model parameter. Values are stored as floats;
+// int and bool parameters are rounded when they are set.
+struct ParamDesc {
+    const char* name;
+    float min, max, def;
+    ParamCurve curve = ParamCurve::Linear;
+    float step = 0.01f, fast_step = 0.1f; // arrow-key increments in the UI
+
+    float Clamp(float v) const { return v < min ? min : (v > max ? max : v); }
+    // Position of v along the curve in [0, 1], for automation and morphing
+    float Normalize(float v) const {
+        v = Clamp(v);
+        if (curve == ParamCurve::Log) return std::log(v / min) / std::log(max / min);
+        return (v - min) / (max - min);
+    }
+    float Denormalize(float n) const {
+        n = n < 0.0f ? 0.0f : (n > 1.0f ? 1.0f : n);
+        if (curve == ParamCurve::Log) return min * std::pow(max / min, n);
+        return min + n * (max - min);
+    }
+};
 
 class DrumModel {
 public:
@@ -9,8 +35,52 @@ public:
     virtual void Trigger() = 0;
     virtual float Process() = 0;
     virtual void RenderControls() = 0;
+    // Recomputes values derived from the parameters (decay factors, filter
+    // coefficients) so Process() does not have to. setParameter calls it;
+    // call it after changing parameters any other way.
+    virtual void UpdateCoefficients() {}
 
     // Serialization interface for saving/loading parameters
     virtual void saveParameters(std::ostream& os) const = 0;
     virtual void loadParameters(std::istream& is) = 0;
-};
\ No newline at end of file
+
+    // Keyed parameter access used by presets and automation. Ids follow the
+    // saveParameters order and must stay stable: append new ones at the end.
+    virtual size_t getParameterCount() const = 0;
+    virtual const ParamDesc& getParameterDesc(size_t id) const = 0;
+    virtual float getParameter(size_t id) const = 0;
+    virtual void setParameter(size_t id, float value) = 0;
+    // setParameter without the UpdateCoefficients call, for applying a batch
+    // of values (parameter locks, queued edits) and updating once
+    virtual void assignParameter(size_t id, float value) = 0;
+    // False for int and bool parameters, which must not be ramped
+    virtual bool isParameterContinuous(size_t id) const = 0;
+
+    void ResetParameters() {
+        for (size_t id = 0; id < getParameterCount(); ++id) setParameter(id, getParameterDesc(id).def);
+    }
+};
+
+// Where a parameter lives in model M. Int and bool members are exposed as
+// floats so every parameter can be stored the same way.
+template <typename M>
+struct ParamField {
+    float M::*f = nullptr;
+    int M::*i = nullptr;
+    bool M::*b = nullptr;
+
+    ParamField(float M::*p) : f(p) {}
+    ParamField(int M::*p) : i(p) {}
+    ParamField(bool M::*p) : b(p) {}
+
+    float get(const M& m) const {
+        if (f) return m.*f;
+        if (i) return (float)(m.*i);
+        return (m.*b) ? 1.0f : 0.0f;
+    }
+    void set(M& m, float v) const {
+        if (f) m.*f = v;
+        else if (i) m.*i = (int)(v + (v < 0.0f ? -0.5f : 0.5f));
+        else m.*b = v >= 0.5f;
+    }
+};
@@ -0,0 +1,86 @@
+#include "FdnReverb.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Line lengths at 48 kHz, mutually prime, about 21 to 60 ms
+constexpr size_t kBaseLengths[FdnReverb::kLines] = {1031, 1327, 1523, 1801, 2063, 2339, 2579, 2897};
+// Rows of an 8x8 Hadamard matrix, for uncorrelated left and right taps
+constexpr float kLeftSigns[FdnReverb::kLines] = {1, -1, 1, -1, 1, -1, 1, -1};
+constexpr float kRightSigns[FdnReverb::kLines] = {1, 1, -1, -1, 1, 1, -1, -1};
+constexpr float kInputGain = 0.25f;
+constexpr float kOutputGain = 0.3f;
+// Keeps the decaying lines out of the denormal range
+constexpr float kAntiDenormal = 1e-20f;
+}
+
+void FdnReverb::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    size_t longest = 0;
+    for (size_t k = 0; k < kLines; ++k) {
+        length_[k] = std::max<size_t>(1, (size_t)(kBaseLengths[k] * sampleRate / 48000.0f));
+        longest = std::max(longest, length_[k]);
+    }
+    lineSize_ = 1;
+    while (lineSize_ <= longest) lineSize_ <<= 1;
+    lines_.assign(kLines * lineSize_, 0.0f);
+    Clear();
+    appliedDecay_ = appliedDamping_ = -1.0f;
+    UpdateCoefficients();
+}
+
+void FdnReverb::SetDecay(float seconds) {
+    decay_.store(std::max(0.1f, std::min(seconds, 20.0f)), std::memory_order_relaxed);
+}
+
+void FdnReverb::SetDamping(float amount) {
+    damping_.store(std::max(0.0f, std::min(amount, 1.0f)), std::memory_order_relaxed);
+}
+
+void FdnReverb::Clear() {
+    std::fill(lines_.begin(), lines_.end(), 0.0f);
+    std::fill(lowpass_, lowpass_ + kLines, 0.0f);
+    write_ = 0;
+}
+
+// Each line loses 60 dB per decay time; damping moves the loop low-pass from
+// 18 kHz down to 1.5 kHz
+void FdnReverb::UpdateCoefficients() {
+    float decay = decay_.load(std::memory_order_relaxed);
+    float damping = damping_.load(std::memory_order_relaxed);
+    if (decay == appliedDecay_ && damping == appliedDamping_) return;
+    for (size_t k = 0; k < kLines; ++k) gain_[k] = std::pow(10.0f, -3.0f * length_[k] / (decay * sampleRate_));
+    float cutoff = 18000.0f * std::pow(1500.0f / 18000.0f, damping);
+    dampingCoef_ = 1.0f - std::exp(-2.0f * (float)M_PI * std::min(cutoff, 0.45f * sampleRate_) / sampleRate_);
+    appliedDecay_ = decay;
+    appliedDamping_ = damping;
+}
+
+void FdnReverb::Process(const float* send, float* left, float* right, size_t frames) {
+    if (lines_.empty()) return;
+    UpdateCoefficients();
+    const size_t mask = lineSize_ - 1;
+    float* lines = lines_.data();
+    for (size_t i = 0; i < frames; ++i) {
+        float x[kLines];
+        for (size_t k = 0; k < kLines; ++k) x[k] = lines[k * lineSize_ + ((write_ - length_[k]) & mask)];
+
+        float l = 0.0f, r = 0.0f, sum = 0.0f;
+        for (size_t k = 0; k < kLines; ++k) {
+            lowpass_[k] += (x[k] - lowpass_[k]) * dampingCoef_;
+            x[k] = lowpass_[k] * gain_[k];
+            l += kLeftSigns[k] * lowpass_[k];
+            r += kRightSigns[k] * lowpass_[k];
+            sum += x[k];
+        }
+        float reflect = sum * (2.0f / kLines);
+        float in = send[i] * kInputGain + kAntiDenormal;
+        for (size_t k = 0; k < kLines; ++k) x[k] = x[k] - reflect + in;
+
+        for (size_t k = 0; k < kLines; ++k) lines[k * lineSize_ + write_] = x[k];
+        write_ = (write_ + 1) & mask;
+        left[i] += l * kOutputGain;
+        right[i] += r * kOutputGain;
+    }
+}
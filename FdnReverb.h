@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Feedback delay network reverb for the send bus: eight delay lines of
+// mutually prime lengths, a damping low-pass in each, and a Householder
+// feedback matrix (x - 2/N * sum(x), so mixing costs O(N)). The eight lines
+// are processed as lanes of fixed-size arrays, which the compiler turns into
+// vector code; only the delay line reads and writes are scalar.
+//
+// Mono in, stereo out through two orthogonal output taps. The GUI sets decay
+// and damping through atomics; Process runs on the audio thread and never
+// allocates.
+class FdnReverb {
+public:
+    static constexpr size_t kLines = 8;
+
+    // Allocates the delay lines; call before the stream starts
+    void Init(float sampleRate);
+
+    // GUI thread. Decay is the RT60 in seconds, damping 0 (bright) to 1 (dark).
+    void SetDecay(float seconds);
+    float decay() const { return decay_.load(std::memory_order_relaxed); }
+    void SetDamping(float amount);
+    float damping() const { return damping_.load(std::memory_order_relaxed); }
+
+    // Adds the reverberated send to left and right
+    void Process(const float* send, float* left, float* right, size_t frames);
+    void Clear();
+
+private:
+    void UpdateCoefficients();
+
+    float sampleRate_ = 48000.0f;
+    size_t lineSize_ = 0; // power of two
+    std::vector<float> lines_;
+    size_t write_ = 0;
+    size_t length_[kLines] = {};
+    float gain_[kLines] = {};
+    float lowpass_[kLines] = {};
+    float dampingCoef_ = 1.0f;
+    float appliedDecay_ = -1.0f;
+    float appliedDamping_ = -1.0f;
+
+    std::atomic<float> decay_{2.0f};
+    std::atomic<float> damping_{0.4f};
+};
@@ -0,0 +1,89 @@
+#include "FileWatcher.h"
+
+#include <chrono>
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr int kWakeMs = 100;     // how often quit_ is checked
+constexpr int kSettleMs = 50;    // quiet time after the last event
+constexpr int kPollingMs = 250;  // mtime polling interval without inotify
+}
+
+FileWatcher::FileWatcher(const std::string& path, std::function<void()> onChange)
+    : path_(path), onChange_(std::move(onChange)), thread_(&FileWatcher::Run, this) {}
+
+FileWatcher::~FileWatcher() {
+    quit_ = true;
+    thread_.join();
+}
+
+void FileWatcher::Run() {
+#ifdef __linux__
+    namespace fs = std::filesystem;
+    fs::path file = fs::absolute(path_);
+    std::string dir = file.parent_path().string();
+    std::string name = file.filename().string();
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0 && inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0) {
+        using Clock = std::chrono::steady_clock;
+        bool pending = false;
+        Clock::time_point lastEvent;
+        alignas(inotify_event) char buf[4096];
+        while (!quit_) {
+            pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, pending ? kSettleMs : kWakeMs) > 0) {
+                ssize_t len;
+                while ((len = read(fd, buf, sizeof(buf))) > 0) {
+                    for (char* p = buf; p < buf + len;) {
+                        auto* ev = reinterpret_cast<inotify_event*>(p);
+                        if (ev->len && name == ev->name) {
+                            pending = true;
+                            lastEvent = Clock::now();
+                        }
+                        p += sizeof(inotify_event) + ev->len;
+                    }
+                }
+            }
+            if (pending && Clock::now() - lastEvent >= std::chrono::milliseconds(kSettleMs)) {
+                pending = false;
+                onChange_();
+            }
+        }
+        close(fd);
+        return;
+    }
+    if (fd >= 0) close(fd);
+#endif
+    Poll();
+}
+
+// Fallback: compare modification time and size
+void FileWatcher::Poll() {
+    namespace fs = std::filesystem;
+    auto stamp = [this](fs::file_time_type& time, uintmax_t& size) {
+        std::error_code ec;
+        time = fs::last_write_time(path_, ec);
+        size = ec ? 0 : fs::file_size(path_, ec);
+        return !ec;
+    };
+    fs::file_time_type lastTime, time;
+    uintmax_t lastSize = 0, size = 0;
+    bool existed = stamp(lastTime, lastSize);
+    int waitedMs = 0;
+    while (!quit_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kWakeMs));
+        if ((waitedMs += kWakeMs) < kPollingMs) continue;
+        waitedMs = 0;
+        bool exists = stamp(time, size);
+        if (exists && (!existed || time != lastTime || size != lastSize)) onChange_();
+        existed = exists;
+        lastTime = time;
+        lastSize = size;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Calls onChange on its own thread whenever the file at path is written or
+// replaced. Uses inotify on Linux, where the directory is watched so that
+// editors that save by renaming a temporary file are noticed too; other
+// platforms poll the modification time. Bursts of events are debounced.
+class FileWatcher {
+public:
+    FileWatcher(const std::string& path, std::function<void()> onChange);
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+private:
+    void Run();
+    void Poll();
+
+    std::string path_;
+    std::function<void()> onChange_;
+    std::atomic<bool> quit_{false};
+    std::thread thread_;
+};
@@ -1,8 +1,6 @@
 // FmClapModel.cpp
 #include "FmClapModel.h"
-#include "CustomControls.h"
 #include <cmath>
-#include <imgui.h>
 
 constexpr float PI = 3.14159265f;
 constexpr float TWO_PI = 2.0f * PI;
@@ -15,7 +13,7 @@ static float WrapPhase(float phase) {
 }
 
 static float ExpDecay(float t, float decay_time) {
-    return std::expf(-t / decay_time);
+    return std::exp(-t / decay_time);
 }
 
 void FmClapModel::Init() {
@@ -32,6 +30,10 @@ void FmClapModel::Trigger() {
     Init();
 }
 
+void FmClapModel::UpdateCoefficients() {
+    hp_alpha = 1.0f / (1.0f + 2.0f * PI * fhp / SAMPLE_RATE);
+}
+
 float FmClapModel::Process() {
     if (!active) return 0.0f;
 
@@ -51,8 +53,7 @@ float FmClapModel::Process() {
     float x = tone * amp_env;
 
     // High-pass filter
-    float alpha = 1.0f / (1.0f + 2.0f * PI * fhp * dt);
-    float y = alpha * (y_prev + x - x_prev);
+    float y = hp_alpha * (y_prev + x - x_prev);
     x_prev = x;
     y_prev = y;
 
@@ -70,15 +71,18 @@ float FmClapModel::Process() {
     return y;
 }
 
-void FmClapModel::RenderControls() {
-    CustomControls::ParameterSlider("f_b (Base Freq)", &f_b, 100.0f, 1200.0f);
-    CustomControls::ParameterSlider("f_m (Mod Freq)", &f_m, 100.0f, 3000.0f);
-    CustomControls::ParameterSlider("bm (Mod Feedback)", &bm, 0.0f, 1.0f);
-    CustomControls::ParameterSlider("I (Mod Index)", &I, 0.0f, 100.0f);
-    CustomControls::ParameterSlider("d_m (Mod Decay)", &d_m, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("d1 (Pre-Clap Decay)", &d1, 0.005f, 0.6f);
-    CustomControls::ParameterSlider("d2 (Final Clap Decay)", &d2, 0.01f, 0.9f);
-    CustomControls::ParameterSliderInt("clap_count", &clap_count, 1, 6);
-    CustomControls::ParameterSlider("clap_interval (s)", &clap_interval, 0.005f, 0.05f);
-    CustomControls::ParameterSlider("fhp (HPF Cutoff)", &fhp, 20.0f, 2000.0f);
-}
\ No newline at end of file
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<FmClapModel> FmClapModel::kParams[] = {
+    {&FmClapModel::f_b, {"f_b (Base Freq)", 100.0f, 1200.0f, 800.0f, ParamCurve::Log}},
+    {&FmClapModel::f_m, {"f_m (Mod Freq)", 100.0f, 3000.0f, 800.0f, ParamCurve::Log}},
+    {&FmClapModel::I, {"I (Mod Index)", 0.0f, 100.0f, 40.0f}},
+    {&FmClapModel::d_m, {"d_m (Mod Decay)", 0.01f, 1.0f, 0.05f, ParamCurve::Log}},
+    {&FmClapModel::d1, {"d1 (Pre-Clap Decay)", 0.005f, 0.6f, 0.02f, ParamCurve::Log}},
+    {&FmClapModel::d2, {"d2 (Final Clap Decay)", 0.01f, 0.9f, 0.3f, ParamCurve::Log}},
+    {&FmClapModel::clap_count, {"clap_count", 1.0f, 6.0f, 3.0f}},
+    {&FmClapModel::clap_interval, {"clap_interval (s)", 0.005f, 0.05f, 0.012f}},
+    {&FmClapModel::fhp, {"fhp (HPF Cutoff)", 20.0f, 2000.0f, 400.0f, ParamCurve::Log}},
+    {&FmClapModel::bm, {"bm (Mod Feedback)", 0.0f, 1.0f, 0.9f}}
+};
+const size_t FmClapModel::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
@@ -1,34 +1,33 @@
 // FmClapModel.h
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
 
-class FmClapModel : public DrumModel {
+class FmClapModel : public ParamModel<FmClapModel> {
 public:
+    FmClapModel() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float Process() override;
-    void RenderControls() override;
+    void UpdateCoefficients() override;
 
-    void saveParameters(std::ostream& os) const override {
-        os << f_b << ' ' << f_m << ' ' << I << ' ' << d_m << ' '
-           << d1 << ' ' << d2 << ' ' << clap_count << ' '
-           << clap_interval << ' ' << fhp << ' ' << bm << '\n';
-    }
+private:
+    friend class ParamModel<FmClapModel>;
+    static const ParamEntry<FmClapModel> kParams[];
+    static const size_t kNumParams;
 
-    void loadParameters(std::istream& is) override {
-        is >> f_b >> f_m >> I >> d_m >> d1 >> d2 >> clap_count >> clap_interval >> fhp >> bm;
-    }
+    // Parameters, set from kParams defaults by the constructor
+    float f_b, f_m, I, d_m;
+    float d1, d2;
+    int clap_count;
+    float clap_interval; // seconds between claps
+    float fhp;
+    float bm; // now user-controllable mod feedback
 
-private:
-    float f_b = 800.0f, f_m = 800.0f, I = 40.0f, d_m = 0.05f;
-    float d1 = 0.02f, d2 = 0.3f;
-    int clap_count = 3, clap_stage = 0;
-    float clap_interval = 0.012f; // seconds between claps
+    int clap_stage = 0;
     float clap_timer = 0.0f;
-    float fhp = 400.0f;
-    float bm = 0.9f; // now user-controllable mod feedback
 
     float mod_phase = 0.0f, car_phase = 0.0f, prev_mod = 0.0f, t = 0.0f;
     float y_prev = 0.0f, x_prev = 0.0f;
+    float hp_alpha = 1.0f; // from UpdateCoefficients()
     bool active = false;
 };
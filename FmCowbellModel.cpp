@@ -1,8 +1,6 @@
 // FmCowbellModel.cpp
 #include "FmCowbellModel.h"
-#include "CustomControls.h"
 #include <cmath>
-#include <imgui.h>
 
 constexpr float PI = 3.14159265f;
 constexpr float TWO_PI = 2.0f * PI;
@@ -15,7 +13,7 @@ static float WrapPhase(float phase) {
 }
 
 static float ExpDecay(float t, float decay_time) {
-    return std::expf(-t / decay_time);
+    return std::exp(-t / decay_time);
 }
 
 void FmCowbellModel::Init() {
@@ -23,6 +21,10 @@ void FmCowbellModel::Init() {
     mod_phase = 0.0f;
     carA_phase = carB_phase = PI / 2.0f;
     prev_mod = 0.0f;
+    UpdateCoefficients();
+}
+
+void FmCowbellModel::UpdateCoefficients() {
     fbB = fbA * 1.48f;
     Ab2 = 1.0f - Ab1;
 }
@@ -58,13 +60,16 @@ float FmCowbellModel::Process() {
     return out;
 }
 
-void FmCowbellModel::RenderControls() {
-    CustomControls::ParameterSlider("fbA (Base Freq)", &fbA, 200.0f, 1000.0f);
-    CustomControls::ParameterSlider("d_b1 (Decay A)", &d_b1, 0.005f, 0.2f);
-    CustomControls::ParameterSlider("db2 (Decay B)", &db2, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("fm (Mod Freq)", &fm, 500.0f, 3000.0f);
-    CustomControls::ParameterSlider("I (Mod Index)", &I, 0.0f, 100.0f);
-    CustomControls::ParameterSlider("dm (Mod Decay)", &dm, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("bm (Mod Feedback)", &bm, 0.0f, 1.0f);
-    CustomControls::ParameterSlider("Ab1 (Envelope Mix A)", &Ab1, 0.0f, 1.0f);
-}
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<FmCowbellModel> FmCowbellModel::kParams[] = {
+    {&FmCowbellModel::fbA, {"fbA (Base Freq)", 200.0f, 1000.0f, 540.0f, ParamCurve::Log}},
+    {&FmCowbellModel::d_b1, {"d_b1 (Decay A)", 0.005f, 0.2f, 0.015f, ParamCurve::Log}},
+    {&FmCowbellModel::db2, {"db2 (Decay B)", 0.01f, 1.0f, 0.1f, ParamCurve::Log}},
+    {&FmCowbellModel::fm, {"fm (Mod Freq)", 500.0f, 3000.0f, 2000.0f, ParamCurve::Log}},
+    {&FmCowbellModel::I, {"I (Mod Index)", 0.0f, 100.0f, 15.0f}},
+    {&FmCowbellModel::dm, {"dm (Mod Decay)", 0.01f, 1.0f, 0.1f, ParamCurve::Log}},
+    {&FmCowbellModel::bm, {"bm (Mod Feedback)", 0.0f, 1.0f, 0.3f}},
+    {&FmCowbellModel::Ab1, {"Ab1 (Envelope Mix A)", 0.0f, 1.0f, 0.7f}}
+};
+const size_t FmCowbellModel::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
@@ -1,30 +1,28 @@
 // FmCowbellModel.h
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
 
-class FmCowbellModel : public DrumModel {
+class FmCowbellModel : public ParamModel<FmCowbellModel> {
 public:
+    FmCowbellModel() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float Process() override;
-    void RenderControls() override;
+    void UpdateCoefficients() override;
 
-    void saveParameters(std::ostream& os) const override {
-        os << fbA << ' ' << d_b1 << ' ' << db2 << ' ' << fm << ' '
-           << I << ' ' << dm << ' ' << bm << ' ' << Ab1 << '\n';
-    }
+private:
+    friend class ParamModel<FmCowbellModel>;
+    static const ParamEntry<FmCowbellModel> kParams[];
+    static const size_t kNumParams;
 
-    void loadParameters(std::istream& is) override {
-        is >> fbA >> d_b1 >> db2 >> fm >> I >> dm >> bm >> Ab1;
-        fbB = fbA * 1.48f;
-        Ab2 = 1.0f - Ab1;
-    }
+    // Parameters, set from kParams defaults by the constructor
+    float fbA;
+    float d_b1, db2;
+    float fm, I, dm, bm;
+    float Ab1;
 
-private:
-    float fbA = 540.0f, fbB = 540.0f * 1.48f;
-    float d_b1 = 0.015f, db2 = 0.1f;
-    float fm = 2000.0f, I = 15.0f, dm = 0.1f, bm = 0.3f;
-    float Ab1 = 0.7f, Ab2 = 1.0f - 0.7f;
+    // Derived, from UpdateCoefficients()
+    float fbB = 0.0f, Ab2 = 0.0f;
 
     float mod_phase = 0.0f, carA_phase = 0.0f, carB_phase = 0.0f, prev_mod = 0.0f, t = 0.0f;
 };
@@ -1,6 +1,5 @@
 // FmCymbalModel.cpp
 #include "FmCymbalModel.h"
-#include "CustomControls.h"
 #include <cmath>
 
 constexpr float PI = 3.14159265f;
@@ -14,7 +13,7 @@ static float WrapPhase(float phase) {
 }
 
 static float ExpDecay(float t, float decay_time) {
-    return std::expf(-t / decay_time);
+    return std::exp(-t / decay_time);
 }
 
 void FmCymbalModel::Init() {
@@ -30,6 +29,10 @@ void FmCymbalModel::Trigger() {
     Init();
 }
 
+void FmCymbalModel::UpdateCoefficients() {
+    hp_alpha = 1.0f / (1.0f + 2.0f * PI * f_hp / SAMPLE_RATE);
+}
+
 float FmCymbalModel::Process() {
     float dt = 1.0f / SAMPLE_RATE;
     float amp_env = sustain + ExpDecay(t, d_b);
@@ -51,8 +54,7 @@ float FmCymbalModel::Process() {
 
     float mixed = sample * 0.25f * amp_env;
 
-    float alpha = 1.0f / (1.0f + 2.0f * PI * f_hp * dt);
-    float y = alpha * (y_prev + mixed - x_prev);
+    float y = hp_alpha * (y_prev + mixed - x_prev);
     x_prev = mixed;
     y_prev = y;
 
@@ -60,13 +62,16 @@ float FmCymbalModel::Process() {
     return y;
 }
 
-void FmCymbalModel::RenderControls() {
-    CustomControls::ParameterSlider("fb (Base Carrier)", &fb, 100.0f, 1000.0f);
-    CustomControls::ParameterSlider("fm (Base Mod)", &fm, 200.0f, 2000.0f);
-    CustomControls::ParameterSlider("d_b (Amp Decay)", &d_b, 0.05f, 4.0f);
-    CustomControls::ParameterSlider("I (FM Index)", &I, 0.0f, 30.0f);
-    CustomControls::ParameterSlider("d_m (Mod Decay)", &d_m, 0.05f, 2.0f);
-    CustomControls::ParameterSlider("bb (Mod Feedback)", &bb, 0.0f, 1.0f);
-    CustomControls::ParameterSlider("sustain", &sustain, 0.0f, 1.0f);
-    CustomControls::ParameterSlider("f_hp (HPF Cutoff)", &f_hp, 100.0f, 2000.0f);
-}
\ No newline at end of file
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<FmCymbalModel> FmCymbalModel::kParams[] = {
+    {&FmCymbalModel::fb, {"fb (Base Carrier)", 100.0f, 1000.0f, 400.0f, ParamCurve::Log}},
+    {&FmCymbalModel::fm, {"fm (Base Mod)", 200.0f, 2000.0f, 800.0f, ParamCurve::Log}},
+    {&FmCymbalModel::d_b, {"d_b (Amp Decay)", 0.05f, 4.0f, 1.0f, ParamCurve::Log}},
+    {&FmCymbalModel::I, {"I (FM Index)", 0.0f, 30.0f, 10.0f}},
+    {&FmCymbalModel::d_m, {"d_m (Mod Decay)", 0.05f, 2.0f, 0.2f, ParamCurve::Log}},
+    {&FmCymbalModel::bb, {"bb (Mod Feedback)", 0.0f, 1.0f, 0.5f}},
+    {&FmCymbalModel::sustain, {"sustain", 0.0f, 1.0f, 0.3f}},
+    {&FmCymbalModel::f_hp, {"f_hp (HPF Cutoff)", 100.0f, 2000.0f, 300.0f, ParamCurve::Log}}
+};
+const size_t FmCymbalModel::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
@@ -1,12 +1,17 @@
 #include "FmKickModel.h"
 #include <cmath>
 #include <imgui.h>
-#include "CustomControls.h"
 
 constexpr float PI = 3.14159265f;
 constexpr float TWO_PI = 2.0f * PI;
 constexpr float SAMPLE_RATE = 48000.0f;
 
+// Parameter ids, rows of kParams
+enum {
+    kBaseFreq, kAmpDecay, kModFreq, kModIndex, kModDecay, kModFeedback,
+    kFreqSweepAmount, kFreqSweepDecay, kUseRatioMode, kRatioIndex, kModEnvSync
+};
+
 static float WrapPhase(float phase) {
     while (phase >= TWO_PI) phase -= TWO_PI;
     while (phase < 0.0f) phase += TWO_PI;
@@ -28,7 +33,7 @@ void FmKickModel::Init() {
 
 void FmKickModel::Trigger() {
     Init();
-    // Calculate decay constants for iterative envelopes WITHOUT std::expf
+    // Calculate decay constants for iterative envelopes WITHOUT std::exp
     float dt = 1.0f / SAMPLE_RATE;
     // For small x, exp(-x) ≈ 1 - x
     amp_decay_const = 1.0f - (dt / d_b);
@@ -88,12 +93,12 @@ void FmKickModel::RenderControls() {
     }
 
     // Carrier frequency (pitch of the drum)
-    CustomControls::ParameterSlider("f_b (Base Frequency)", &f_b, 20.0f, 100.0f);
+    RenderParameter(kBaseFreq);
 
     // UI: Ratio mode toggle
-    ImGui::Checkbox("Lock Modulator to Ratio", &use_ratio_mode);
+    RenderParameter(kUseRatioMode);
     if (use_ratio_mode) {
-        ImGui::SliderInt("Modulator Ratio Index", &ratio_index, 0, num_ratios - 1);
+        RenderParameter(kRatioIndex);
         if (ImGui::IsItemHovered()) {
             float num = ratios[ratio_index][0];
             float den = ratios[ratio_index][1];
@@ -103,26 +108,43 @@ void FmKickModel::RenderControls() {
         }
     } else {
         // Modulator frequency (determines harmonic complexity)
-        CustomControls::ParameterSlider("f_m (Modulator Freq)", &f_m, 50.0f, 2000.0f);
+        RenderParameter(kModFreq);
     }
     // New: Sync modulator freq envelope to carrier
-    ImGui::Checkbox("Sync Modulator Freq Envelope to Carrier", &mod_env_sync);
+    RenderParameter(kModEnvSync);
 
     // Volume envelope decay (controls how long the drum rings out)
-    CustomControls::ParameterSlider("d_b (Amp Decay)", &d_b, 0.01f, 2.0f);
+    RenderParameter(kAmpDecay);
 
     // Modulation index (depth of FM, sharpness of attack)
-    CustomControls::ParameterSlider("I (Mod Index)", &I, 0.0f, 10.0f, 0.001f, 0.01f);
+    RenderParameter(kModIndex);
 
     // Modulator envelope decay (shorter = clickier attack)
-    CustomControls::ParameterSlider("d_m (Mod Decay)", &d_m, 0.001f, 2.0f, 0.001f, 0.01f);
+    RenderParameter(kModDecay);
 
     // Feedback on the modulator (adds noise/grit to tone)
-    CustomControls::ParameterSlider("b_m (Mod Feedback)", &b_m, .0f, 16.0f, 1, 2);
+    RenderParameter(kModFeedback);
 
     // Frequency sweep amount (in Hz)
-    CustomControls::ParameterSlider("A_f (Freq Sweep Amt)", &A_f, 0.0f, 1000.0f);
+    RenderParameter(kFreqSweepAmount);
 
     // Frequency envelope decay (how fast pitch sweep drops)
-    CustomControls::ParameterSlider("d_f (Freq Sweep Decay)", &d_f, 0.001f, 2.0f, 0.001f, 0.01f  );
-}
\ No newline at end of file
+    RenderParameter(kFreqSweepDecay);
+}
+
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<FmKickModel> FmKickModel::kParams[] = {
+    {&FmKickModel::f_b, {"f_b (Base Frequency)", 20.0f, 100.0f, 50.0f, ParamCurve::Log}},
+    {&FmKickModel::d_b, {"d_b (Amp Decay)", 0.01f, 2.0f, 0.5f, ParamCurve::Log}},
+    {&FmKickModel::f_m, {"f_m (Modulator Freq)", 50.0f, 2000.0f, 180.0f, ParamCurve::Log}},
+    {&FmKickModel::I, {"I (Mod Index)", 0.0f, 20.0f, 20.0f, ParamCurve::Linear, 0.001f, 0.01f}},
+    {&FmKickModel::d_m, {"d_m (Mod Decay)", 0.001f, 2.0f, 0.15f, ParamCurve::Log, 0.001f, 0.01f}},
+    {&FmKickModel::b_m, {"b_m (Mod Feedback)", 0.0f, 16.0f, 0.5f, ParamCurve::Linear, 1.0f, 2.0f}},
+    {&FmKickModel::A_f, {"A_f (Freq Sweep Amt)", 0.0f, 1000.0f, 60.0f}},
+    {&FmKickModel::d_f, {"d_f (Freq Sweep Decay)", 0.001f, 2.0f, 0.1f, ParamCurve::Log, 0.001f, 0.01f}},
+    {&FmKickModel::use_ratio_mode, {"Lock Modulator to Ratio", 0.0f, 1.0f, 0.0f}},
+    {&FmKickModel::ratio_index, {"Modulator Ratio Index", 0.0f, num_ratios - 1, 0.0f}},
+    {&FmKickModel::mod_env_sync, {"Sync Modulator Freq Envelope to Carrier", 0.0f, 1.0f, 0.0f}}
+};
+const size_t FmKickModel::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
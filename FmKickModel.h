@@ -1,27 +1,27 @@
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
 #include "mi/operator.h"
 
-class FmKickModel : public DrumModel {
+class FmKickModel : public ParamModel<FmKickModel> {
 public:
+    FmKickModel() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float Process() override;
     void RenderControls() override;
-    void saveParameters(std::ostream& os) const override {
-        os << f_b << ' ' << d_b << ' ' << f_m << ' ' << I << ' ' << d_m << ' ' << b_m << ' ' << A_f << ' ' << d_f << ' ' << use_ratio_mode << ' ' << ratio_index << ' ' << mod_env_sync << '\n';
-    }
-    void loadParameters(std::istream& is) override {
-        is >> f_b >> d_b >> f_m >> I >> d_m >> b_m >> A_f >> d_f >> use_ratio_mode >> ratio_index >> mod_env_sync;
-    }
 
 private:
-    float f_b = 50.0f, d_b = 0.5f, f_m = 180.0f, I = 20.0f;
-    float d_m = 0.15f, b_m = 0.5f, A_f = 60.0f, d_f = 0.1f;
+    friend class ParamModel<FmKickModel>;
+    static const ParamEntry<FmKickModel> kParams[];
+    static const size_t kNumParams;
+
+    // Parameters, set from kParams defaults by the constructor
+    float f_b, d_b, f_m, I;
+    float d_m, b_m, A_f, d_f;
 
     // Ratio mode for modulator frequency
-    bool use_ratio_mode = false;
-    int ratio_index = 0; // Index into ratio array
+    bool use_ratio_mode;
+    int ratio_index; // Index into ratio array
     static constexpr int num_ratios = 64;
     static constexpr float ratios[num_ratios][2] = {
         // Integer multiples 2:1 to 40:1
@@ -46,5 +46,5 @@ private:
     float fb_state[2] = {0.0f, 0.0f};
     float t = 0.0f;
 
-    bool mod_env_sync = false; // New: sync modulator freq envelope to carrier
+    bool mod_env_sync; // New: sync modulator freq envelope to carrier
 };
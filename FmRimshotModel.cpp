@@ -1,6 +1,5 @@
 // FmRimshotModel.cpp
 #include "FmRimshotModel.h"
-#include "CustomControls.h"
 #include <cmath>
 
 constexpr float SAMPLE_RATE = 48000.0f;
@@ -14,7 +13,7 @@ float WrapPhase(float phase) {
 }
 
 float ExpDecay(float t, float decay_time) {
-    return std::expf(-t / decay_time);
+    return std::exp(-t / decay_time);
 }
 
 void FmRimshotModel::Init() {
@@ -27,6 +26,10 @@ void FmRimshotModel::Trigger() {
     Init();
 }
 
+void FmRimshotModel::UpdateCoefficients() {
+    hp_alpha = 1.0f / (1.0f + 2.0f * PI * f_hp / SAMPLE_RATE);
+}
+
 float FmRimshotModel::Process() {
     float dt = 1.0f / SAMPLE_RATE;
 
@@ -45,8 +48,7 @@ float FmRimshotModel::Process() {
 
     float mixed = (1.0f - A_A) * (carB * envB) + A_A * (carA * envA);
 
-    float alpha = 1.0f / (1.0f + 2.0f * PI * f_hp * dt);
-    float y = alpha * (y_prev + mixed - x_prev);
+    float y = hp_alpha * (y_prev + mixed - x_prev);
     x_prev = mixed;
     y_prev = y;
 
@@ -54,16 +56,17 @@ float FmRimshotModel::Process() {
     return y;
 }
 
-void FmRimshotModel::RenderControls() {
-    CustomControls::ParameterSlider("f_bB (rim freq)", &f_bB, 200.0f, 1000.0f);
-    CustomControls::ParameterSlider("d_bB (rim decay)", &d_bB, 0.01f, 0.5f);
-    CustomControls::ParameterSlider("I_B (rim mod index)", &I_B, 0.0f, 50.0f);
-
-    CustomControls::ParameterSlider("f_bA (body freq)", &f_bA, 80.0f, 400.0f);
-    CustomControls::ParameterSlider("d_bA (body decay)", &d_bA, 0.05f, 1.0f);
-    CustomControls::ParameterSlider("I_A (body mod index)", &I_A, 0.0f, 50.0f);
-
-    CustomControls::ParameterSlider("A_A (body mix)", &A_A, 0.0f, 1.0f);
-    CustomControls::ParameterSlider("d_m (mod env decay)", &d_m, 0.01f, 0.5f);
-    CustomControls::ParameterSlider("f_hp (HPF cutoff)", &f_hp, 100.0f, 2000.0f);
-}
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<FmRimshotModel> FmRimshotModel::kParams[] = {
+    {&FmRimshotModel::f_bB, {"f_bB (rim freq)", 200.0f, 1000.0f, 600.0f, ParamCurve::Log}},
+    {&FmRimshotModel::d_bB, {"d_bB (rim decay)", 0.01f, 0.5f, 0.05f, ParamCurve::Log}},
+    {&FmRimshotModel::I_B, {"I_B (rim mod index)", 0.0f, 50.0f, 15.0f}},
+    {&FmRimshotModel::f_bA, {"f_bA (body freq)", 80.0f, 400.0f, 200.0f, ParamCurve::Log}},
+    {&FmRimshotModel::d_bA, {"d_bA (body decay)", 0.05f, 1.0f, 0.25f, ParamCurve::Log}},
+    {&FmRimshotModel::I_A, {"I_A (body mod index)", 0.0f, 50.0f, 10.0f}},
+    {&FmRimshotModel::A_A, {"A_A (body mix)", 0.0f, 1.0f, 0.4f}},
+    {&FmRimshotModel::d_m, {"d_m (mod env decay)", 0.01f, 0.5f, 0.05f, ParamCurve::Log}},
+    {&FmRimshotModel::f_hp, {"f_hp (HPF cutoff)", 100.0f, 2000.0f, 400.0f, ParamCurve::Log}}
+};
+const size_t FmRimshotModel::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
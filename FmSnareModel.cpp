@@ -1,10 +1,7 @@
 // FmSnareModel.cpp
 #include "FmSnareModel.h"
-#include "CustomControls.h"
 #include "mi/operator.h"
 #include <cmath>
-#include <cstdlib>
-#include <imgui.h>
 
 constexpr float SAMPLE_RATE = 48000.0f;
 constexpr float PI = 3.14159265f;
@@ -19,7 +16,7 @@ void FmSnareModel::Init() {
     amp_env = 1.0f;
     mod_env = 1.0f;
     noise_env = 1.0f;
-    // Calculate decay constants for iterative envelopes WITHOUT std::expf
+    // Calculate decay constants for iterative envelopes WITHOUT std::exp
     float dt = 1.0f / SAMPLE_RATE;
     amp_decay_const = 1.0f - (dt / d_b);
     mod_decay_const = 1.0f - (dt / d_m);
@@ -33,6 +30,10 @@ void FmSnareModel::Trigger() {
     Init();
 }
 
+void FmSnareModel::UpdateCoefficients() {
+    hp_alpha = 1.0f / (1.0f + 2.0f * PI * fhp / SAMPLE_RATE);
+}
+
 float FmSnareModel::Process() {
     float dt = 1.0f / SAMPLE_RATE;
     // Iterative envelope decay
@@ -69,23 +70,25 @@ float FmSnareModel::Process() {
         car_ops[0], car_f, car_a, dummy_fb, 0, car_mod, car_buf, 1);
     float tone = car_buf[0];
 
-    float white = ((float(rand()) / RAND_MAX) * 2.0f - 1.0f) * Abrus * noise_env;
+    float white = noiseSource.Next() * Abrus * noise_env;
     float x = tone + white;
-    float alpha = 1.0f / (1.0f + 2.0f * PI * fhp * dt);
-    float y = alpha * (y_prev + x - x_prev);
+    float y = hp_alpha * (y_prev + x - x_prev);
     x_prev = x;
     y_prev = y;
     t += dt;
     return y * amp_env;
 }
 
-void FmSnareModel::RenderControls() {
-    CustomControls::ParameterSlider("f_b (Tone Freq)", &f_b, 100.0f, 400.0f);
-    CustomControls::ParameterSlider("d_b (Tone Decay)", &d_b, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("f_m (Mod Freq)", &f_m, 500.0f, 3000.0f);
-    CustomControls::ParameterSlider("I (Mod Index)", &I, 0.0f, 50.0f);
-    CustomControls::ParameterSlider("d_m (Mod Decay)", &d_m, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("Abrus (Noise Level)", &Abrus, 0.0f, 1.0f);
-    CustomControls::ParameterSlider("dbrus (Noise Decay)", &dbrus, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("fhp (HPF Cutoff)", &fhp, 20.0f, 2000.0f);
-}
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<FmSnareModel> FmSnareModel::kParams[] = {
+    {&FmSnareModel::f_b, {"f_b (Tone Freq)", 100.0f, 400.0f, 200.0f, ParamCurve::Log}},
+    {&FmSnareModel::d_b, {"d_b (Tone Decay)", 0.01f, 1.0f, 0.4f, ParamCurve::Log}},
+    {&FmSnareModel::f_m, {"f_m (Mod Freq)", 500.0f, 3000.0f, 1500.0f, ParamCurve::Log}},
+    {&FmSnareModel::I, {"I (Mod Index)", 0.0f, 50.0f, 15.0f}},
+    {&FmSnareModel::d_m, {"d_m (Mod Decay)", 0.01f, 1.0f, 0.1f, ParamCurve::Log}},
+    {&FmSnareModel::Abrus, {"Abrus (Noise Level)", 0.0f, 1.0f, 0.5f}},
+    {&FmSnareModel::dbrus, {"dbrus (Noise Decay)", 0.01f, 1.0f, 0.3f, ParamCurve::Log}},
+    {&FmSnareModel::fhp, {"fhp (HPF Cutoff)", 20.0f, 2000.0f, 400.0f, ParamCurve::Log}}
+};
+const size_t FmSnareModel::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
@@ -1,37 +1,38 @@
 // FmSnareModel.h
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
+#include "WhiteNoise.h"
 #include "mi/operator.h"
 
-class FmSnareModel : public DrumModel {
+class FmSnareModel : public ParamModel<FmSnareModel> {
 public:
+    FmSnareModel() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float Process() override;
-    void RenderControls() override;
-    void saveParameters(std::ostream& os) const override {
-        os << f_b << ' ' << d_b << ' ' << f_m << ' ' << I << ' ' << d_m << ' ' << Abrus << ' ' << dbrus << ' ' << fhp << '\n';
-    }
-    void loadParameters(std::istream& is) override {
-        is >> f_b >> d_b >> f_m >> I >> d_m >> Abrus >> dbrus >> fhp;
-    }
+    void UpdateCoefficients() override;
 
 private:
-    // FM parameters
-    float f_b = 200.0f;     // Carrier frequency
-    float d_b = 0.4f;       // Amplitude envelope decay
-    float f_m = 1500.0f;    // Modulator frequency
-    float I = 15.0f;        // Modulation index
-    float d_m = 0.1f;       // Modulator envelope decay
+    friend class ParamModel<FmSnareModel>;
+    static const ParamEntry<FmSnareModel> kParams[];
+    static const size_t kNumParams;
+
+    // FM parameters (defaults in kParams)
+    float f_b;     // Carrier frequency
+    float d_b;     // Amplitude envelope decay
+    float f_m;     // Modulator frequency
+    float I;       // Modulation index
+    float d_m;     // Modulator envelope decay
 
     // Noise and filter
-    float Abrus = 0.5f;     // Noise level
-    float dbrus = 0.3f;     // Noise envelope decay
-    float fhp = 400.0f;     // High-pass filter cutoff (Hz)
+    float Abrus;   // Noise level
+    float dbrus;   // Noise envelope decay
+    float fhp;     // High-pass filter cutoff (Hz)
 
     // Internal state
     float t = 0.0f;
     float y_prev = 0.0f, x_prev = 0.0f; // HPF state
+    float hp_alpha = 1.0f; // from UpdateCoefficients()
 
     // Envelope states and decay constants
     float amp_env = 1.0f;
@@ -45,4 +46,8 @@ private:
     plaits::fm::Operator modulator_;
     plaits::fm::Operator carrier_;
     float fb_state_[2] = {0.0f, 0.0f};
+
+    // Seeded on construction, not in Init(), which every trigger calls:
+    // a fresh model (the render cache's) is repeatable, live hits vary
+    WhiteNoise noiseSource{0x5eed5a4e};
 };
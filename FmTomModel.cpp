@@ -1,8 +1,6 @@
 // FmTomModel.cpp
 #include "FmTomModel.h"
-#include "CustomControls.h"
 #include <cmath>
-#include <imgui.h>
 
 constexpr float SAMPLE_RATE = 48000.0f;
 constexpr float PI = 3.14159265f;
@@ -15,7 +13,7 @@ static float WrapPhase(float phase) {
 }
 
 static float ExpDecay(float t, float decay_time) {
-    return std::expf(-t / decay_time);
+    return std::exp(-t / decay_time);
 }
 
 void FmTomModel::Init() {
@@ -46,13 +44,16 @@ float FmTomModel::Process() {
     return out;
 }
 
-void FmTomModel::RenderControls() {
-    CustomControls::ParameterSlider("f_b (Base Frequency)", &f_b, 80.0f, 400.0f);
-    CustomControls::ParameterSlider("d_b (Amp Decay)", &d_b, 0.01f, 2.0f);
-    CustomControls::ParameterSlider("f_m (Modulator Freq)", &f_m, 100.0f, 2000.0f);
-    CustomControls::ParameterSlider("I (Mod Index)", &I, 0.0f, 50.0f);
-    CustomControls::ParameterSlider("d_m (Mod Decay)", &d_m, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("A_f (Freq Sweep Amt)", &A_f, 0.0f, 100.0f);
-    CustomControls::ParameterSlider("d_f (Freq Sweep Decay)", &d_f, 0.01f, 1.0f);
-    CustomControls::ParameterSlider("Start Phase", &start_phase, 0.0f, PI);
-}
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<FmTomModel> FmTomModel::kParams[] = {
+    {&FmTomModel::f_b, {"f_b (Base Frequency)", 80.0f, 400.0f, 150.0f, ParamCurve::Log}},
+    {&FmTomModel::d_b, {"d_b (Amp Decay)", 0.01f, 2.0f, 0.7f, ParamCurve::Log}},
+    {&FmTomModel::f_m, {"f_m (Modulator Freq)", 100.0f, 2000.0f, 300.0f, ParamCurve::Log}},
+    {&FmTomModel::I, {"I (Mod Index)", 0.0f, 50.0f, 15.0f}},
+    {&FmTomModel::d_m, {"d_m (Mod Decay)", 0.01f, 1.0f, 0.2f, ParamCurve::Log}},
+    {&FmTomModel::A_f, {"A_f (Freq Sweep Amt)", 0.0f, 100.0f, 30.0f}},
+    {&FmTomModel::d_f, {"d_f (Freq Sweep Decay)", 0.01f, 1.0f, 0.1f, ParamCurve::Log}},
+    {&FmTomModel::start_phase, {"Start Phase", 0.0f, PI, PI / 2.0f}}
+};
+const size_t FmTomModel::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+
+// Running RMS/peak meter with exponential ballistics. Process() is fed from
+// the audio thread and Publish() makes the current values visible to the GUI
+// through atomics, so reading a level is a single load per frame.
+class LevelMeter {
+public:
+    void Init(float sample_rate, float rms_time = 0.3f, float peak_release = 1.5f) {
+        rms_coef_ = 1.0f - std::exp(-1.0f / (rms_time * sample_rate));
+        peak_decay_ = std::exp(-1.0f / (peak_release * sample_rate));
+        mean_square_ = 0.0f;
+        peak_state_ = 0.0f;
+        rms_.store(0.0f, std::memory_order_relaxed);
+        peak_.store(0.0f, std::memory_order_relaxed);
+    }
+
+    inline void Process(float x) {
+        mean_square_ += (x * x - mean_square_) * rms_coef_;
+        float a = std::fabs(x);
+        peak_state_ = a > peak_state_ ? a : peak_state_ * peak_decay_;
+    }
+
+    // Equivalent to feeding n zero samples
+    inline void Idle(unsigned int n) {
+        if (mean_square_ == 0.0f && peak_state_ == 0.0f) return;
+        mean_square_ *= std::pow(1.0f - rms_coef_, (float)n);
+        peak_state_ *= std::pow(peak_decay_, (float)n);
+        if (mean_square_ < 1e-20f) mean_square_ = 0.0f;
+        if (peak_state_ < 1e-10f) peak_state_ = 0.0f;
+    }
+
+    // Call once per audio block
+    inline void Publish() {
+        rms_.store(std::sqrt(mean_square_), std::memory_order_relaxed);
+        peak_.store(peak_state_, std::memory_order_relaxed);
+    }
+
+    float rms() const { return rms_.load(std::memory_order_relaxed); }
+    float peak() const { return peak_.load(std::memory_order_relaxed); }
+
+private:
+    float rms_coef_ = 0.0f;
+    float peak_decay_ = 0.0f;
+    float mean_square_ = 0.0f;
+    float peak_state_ = 0.0f;
+    std::atomic<float> rms_{0.0f};
+    std::atomic<float> peak_{0.0f};
+};
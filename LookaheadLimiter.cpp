@@ -0,0 +1,145 @@
+#include "LookaheadLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Fall time of the gain reduction display
+constexpr float kDisplaySeconds = 0.3f;
+}
+
+void LookaheadLimiter::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    size_t longest = (size_t)std::ceil(kMaxLookaheadMs * sampleRate / 1000.0f);
+    leaves_ = 1;
+    while (leaves_ < longest) leaves_ <<= 1;
+    delaySize_ = 1;
+    while (delaySize_ <= longest + kTaps / 2) delaySize_ <<= 1;
+    tree_.assign(2 * leaves_, 0.0f);
+    gains_.assign(longest, 1.0f);
+    delayLeft_.assign(delaySize_, 0.0f);
+    delayRight_.assign(delaySize_, 0.0f);
+
+    // Point 0 is the sample between the two middle taps itself; points 1-3
+    // are Hann-windowed sinc phases at a quarter, half and three quarters of
+    // the way to the next sample, each normalised to unity gain
+    for (size_t k = 0; k < kPoints; ++k) {
+        float sum = 0.0f;
+        for (size_t j = 0; j < kTaps; ++j) {
+            float d = (kTaps / 2 - 1) + k / (float)kPoints - (float)j;
+            float sinc = d == 0.0f ? 1.0f : std::sin((float)M_PI * d) / ((float)M_PI * d);
+            float window = 0.5f + 0.5f * std::cos((float)M_PI * d / (kTaps / 2));
+            phases_[j][k] = sinc * window;
+            sum += phases_[j][k];
+        }
+        for (size_t j = 0; j < kTaps; ++j) phases_[j][k] /= sum;
+    }
+    active_ = false;
+    reductionDb_.store(0.0f, std::memory_order_relaxed);
+}
+
+void LookaheadLimiter::SetCeiling(float db) {
+    ceiling_.store(std::max(-12.0f, std::min(db, 0.0f)), std::memory_order_relaxed);
+}
+
+void LookaheadLimiter::SetLookahead(float ms) {
+    lookahead_.store(std::max(kMinLookaheadMs, std::min(ms, kMaxLookaheadMs)), std::memory_order_relaxed);
+}
+
+void LookaheadLimiter::SetRelease(float ms) {
+    release_.store(std::max(10.0f, std::min(ms, 1000.0f)), std::memory_order_relaxed);
+}
+
+void LookaheadLimiter::Reset() {
+    std::fill(tree_.begin(), tree_.end(), 0.0f);
+    std::fill(gains_.begin(), gains_.end(), 1.0f);
+    std::fill(delayLeft_.begin(), delayLeft_.end(), 0.0f);
+    std::fill(delayRight_.begin(), delayRight_.end(), 0.0f);
+    for (float* h : history_) std::fill(h, h + 2 * kTaps, 0.0f);
+    historyPos_ = windowPos_ = delayPos_ = 0;
+    gainSum_ = (double)window_;
+    released_ = 1.0f;
+    held_ = 0.0f;
+}
+
+void LookaheadLimiter::Configure() {
+    float frames = std::round(appliedLookahead_ * sampleRate_ / 1000.0f);
+    window_ = std::max<size_t>(1, std::min((size_t)frames, gains_.size()));
+    Reset();
+}
+
+// Peak of the frame four samples back and of the signal between it and the
+// next one
+float LookaheadLimiter::TruePeak(float left, float right) {
+    history_[0][historyPos_] = history_[0][historyPos_ + kTaps] = left;
+    history_[1][historyPos_] = history_[1][historyPos_ + kTaps] = right;
+    historyPos_ = (historyPos_ + 1) & (kTaps - 1);
+    // The four points are lanes, so each tap is one vector multiply-add
+    float y[2][kPoints] = {};
+    for (size_t c = 0; c < 2; ++c) {
+        const float* x = history_[c] + historyPos_; // oldest first
+        for (size_t j = 0; j < kTaps; ++j) {
+            for (size_t k = 0; k < kPoints; ++k) y[c][k] += phases_[j][k] * x[j];
+        }
+    }
+    float peak = 0.0f;
+    for (size_t k = 0; k < kPoints; ++k) peak = std::max(peak, std::max(std::fabs(y[0][k]), std::fabs(y[1][k])));
+    return peak;
+}
+
+void LookaheadLimiter::Process(float* left, float* right, size_t frames) {
+    if (tree_.empty() || frames == 0) return;
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        active_ = false;
+        reductionDb_.store(0.0f, std::memory_order_relaxed);
+        latency_.store(0, std::memory_order_relaxed);
+        return;
+    }
+    float lookahead = lookahead_.load(std::memory_order_relaxed);
+    if (!active_ || lookahead != appliedLookahead_) {
+        appliedLookahead_ = lookahead;
+        Configure();
+        active_ = true;
+    }
+    float ceiling = std::pow(10.0f, ceiling_.load(std::memory_order_relaxed) / 20.0f);
+    float releaseCoef = 1.0f - std::exp(-1000.0f / (release_.load(std::memory_order_relaxed) * sampleRate_));
+    const size_t delay = window_ - 1 + kTaps / 2;
+    latency_.store(delay, std::memory_order_relaxed);
+    const size_t mask = delaySize_ - 1;
+    const double average = 1.0 / window_;
+    float minGain = 1.0f;
+
+    for (size_t i = 0; i < frames; ++i) {
+        // Each parent is the larger of the new value and the sibling's, so
+        // the walk never reads back what it just wrote
+        float peak = TruePeak(left[i], right[i]);
+        size_t node = leaves_ + windowPos_;
+        tree_[node] = peak;
+        for (; node > 1; node >>= 1) {
+            peak = std::max(peak, tree_[node ^ 1]);
+            tree_[node >> 1] = peak;
+        }
+
+        // Attack at once to the gain the window needs, then release; the
+        // average over the window turns the step into a ramp that is
+        // complete when the peak leaves the delay
+        float target = peak > ceiling ? ceiling / peak : 1.0f;
+        released_ = target < released_ ? target : released_ + (target - released_) * releaseCoef;
+        gainSum_ += released_ - gains_[windowPos_];
+        gains_[windowPos_] = released_;
+        if (++windowPos_ == window_) windowPos_ = 0;
+        float gain = std::min(1.0f, (float)(gainSum_ * average));
+
+        delayLeft_[delayPos_] = left[i];
+        delayRight_[delayPos_] = right[i];
+        size_t read = (delayPos_ - delay) & mask;
+        delayPos_ = (delayPos_ + 1) & mask;
+        left[i] = delayLeft_[read] * gain;
+        right[i] = delayRight_[read] * gain;
+        minGain = std::min(minGain, gain);
+    }
+
+    float db = -20.0f * std::log10(minGain);
+    held_ = std::max(db, held_ * std::exp(-(float)frames / (kDisplaySeconds * sampleRate_)));
+    reductionDb_.store(held_, std::memory_order_relaxed);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Stereo-linked lookahead limiter for the main bus. Each input frame gets a
+// true-peak estimate: the larger of its sample peak and three 4x oversampled
+// points between it and the next sample, interpolated with 8-tap windowed
+// sinc phases. The gain needed to keep that peak under the ceiling is held
+// over the lookahead window, released with a one-pole, and then averaged
+// over the same window. The gain therefore ramps down over the lookahead
+// time and reaches its target by the time the delayed peak is output.
+//
+// The window maximum comes from a max-tree over a circular buffer. Each
+// sample updates one leaf and walks its fixed number of levels to the
+// root. The window average is a running sum. Every frame costs the same no
+// matter what the signal does, so a block's cost depends only on its
+// length. Latency is the lookahead plus four frames for the interpolator.
+//
+// The GUI sets everything through atomics. A new lookahead time restarts
+// the limiter, and disabling it bypasses the delay as well. Process runs on
+// the audio thread and never allocates.
+class LookaheadLimiter {
+public:
+    static constexpr float kMinLookaheadMs = 1.0f;
+    static constexpr float kMaxLookaheadMs = 5.0f;
+
+    // Allocates the delay lines for the longest lookahead; call before the
+    // stream starts
+    void Init(float sampleRate);
+
+    // GUI thread
+    void SetEnabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void SetCeiling(float db); // -12 to 0 dB true peak
+    float ceiling() const { return ceiling_.load(std::memory_order_relaxed); }
+    void SetLookahead(float ms); // 1-5 ms
+    float lookahead() const { return lookahead_.load(std::memory_order_relaxed); }
+    void SetRelease(float ms); // 10-1000 ms
+    float release() const { return release_.load(std::memory_order_relaxed); }
+    // Gain reduction in dB (positive), held on peaks and falling back
+    // gradually so the GUI sees short reductions
+    float reduction() const { return reductionDb_.load(std::memory_order_relaxed); }
+    // Frames the last Process delayed its output by, 0 when bypassed; any
+    // thread, for outputs that bypass the limiter to stay in time with it
+    size_t latency() const { return latency_.load(std::memory_order_relaxed); }
+    size_t maxLatency() const { return gains_.empty() ? 0 : gains_.size() - 1 + kTaps / 2; } // after Init
+
+    // In place; left and right hold the same frames delayed by the latency
+    void Process(float* left, float* right, size_t frames);
+    void Reset();
+
+private:
+    static constexpr size_t kTaps = 8;   // per oversampling phase
+    static constexpr size_t kPoints = 4; // the sample and three between it and the next
+
+    float TruePeak(float left, float right);
+    void Configure();
+
+    float sampleRate_ = 48000.0f;
+    size_t window_ = 1;  // lookahead in frames
+    size_t leaves_ = 1;  // max-tree leaves, power of two
+    size_t delaySize_ = 1;
+    std::vector<float> tree_;   // 2 * leaves_ nodes, root at 1
+    std::vector<float> gains_;  // last window_ released gains
+    std::vector<float> delayLeft_, delayRight_;
+    float phases_[kTaps][kPoints] = {};
+    float history_[2][2 * kTaps] = {}; // doubled so the taps read contiguously
+
+    size_t historyPos_ = 0, windowPos_ = 0, delayPos_ = 0;
+    double gainSum_ = 0.0;
+    float released_ = 1.0f;
+    float held_ = 0.0f; // reduction display, dB
+    bool active_ = false;
+    float appliedLookahead_ = 0.0f;
+
+    std::atomic<bool> enabled_{true};
+    std::atomic<float> ceiling_{-1.0f};
+    std::atomic<float> lookahead_{3.0f};
+    std::atomic<float> release_{100.0f};
+    std::atomic<float> reductionDb_{0.0f};
+    std::atomic<size_t> latency_{0};
+};
@@ -0,0 +1,205 @@
+#include "ModMatrix.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Settings words: LFO rate | delay << 7 | waveform << 14 | retrigger << 17,
+// slot used << 63 | source << 56 | track << 48 | param << 32 | depth bits
+static uint32_t PackLfo(const ModMatrix::LfoSettings& s) {
+    return (uint32_t)s.rate | (uint32_t)s.delay << 7 | (uint32_t)s.waveform << 14 | (uint32_t)s.retrigger << 17;
+}
+
+static ModMatrix::LfoSettings UnpackLfo(uint32_t w) {
+    ModMatrix::LfoSettings s;
+    s.rate = w & 0x7f;
+    s.delay = (w >> 7) & 0x7f;
+    s.waveform = (w >> 14) & 0x7;
+    s.retrigger = (w >> 17) & 1;
+    return s;
+}
+
+constexpr uint64_t kSlotUsed = uint64_t(1) << 63;
+
+ModMatrix::ModMatrix(float sampleRate) : sampleRate_(sampleRate) {
+    for (size_t t = 0; t < kTracks; ++t) {
+        lfoSettings_[t].store(PackLfo(LfoSettings()));
+        lfos_[t].Init(sampleRate_);
+        appliedLfo_[t] = ~0u; // applied on the first tick
+    }
+    for (size_t s = 0; s < kSlots; ++s) slots_[s].store(0);
+}
+
+void ModMatrix::SetLfo(size_t track, const LfoSettings& settings) {
+    LfoSettings s = settings;
+    s.rate = s.rate < 0 ? 0 : (s.rate > 99 ? 99 : s.rate);
+    s.delay = s.delay < 0 ? 0 : (s.delay > 99 ? 99 : s.delay);
+    s.waveform = s.waveform < 0 ? 0 : (s.waveform > plaits::fm::Lfo::WAVEFORM_S_AND_H ? plaits::fm::Lfo::WAVEFORM_S_AND_H : s.waveform);
+    lfoSettings_[track].store(PackLfo(s), std::memory_order_relaxed);
+}
+
+ModMatrix::LfoSettings ModMatrix::lfo(size_t track) const {
+    return UnpackLfo(lfoSettings_[track].load(std::memory_order_relaxed));
+}
+
+void ModMatrix::SetSlot(size_t slot, const Slot& settings) {
+    if (settings.source < 0 || settings.source >= (int)kTracks || settings.track < 0 || settings.track >= (int)kTracks) {
+        slots_[slot].store(0, std::memory_order_relaxed);
+        return;
+    }
+    float depth = settings.depth < -1.0f ? -1.0f : (settings.depth > 1.0f ? 1.0f : settings.depth);
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    uint64_t w = kSlotUsed | (uint64_t)settings.source << 56 | (uint64_t)settings.track << 48
+                 | (uint64_t)(uint16_t)settings.param << 32 | bits;
+    slots_[slot].store(w, std::memory_order_relaxed);
+}
+
+ModMatrix::Slot ModMatrix::slot(size_t slot) const {
+    uint64_t w = slots_[slot].load(std::memory_order_relaxed);
+    Slot s;
+    if (!(w & kSlotUsed)) return s;
+    s.source = (w >> 56) & 0x7f;
+    s.track = (w >> 48) & 0xff;
+    s.param = (w >> 32) & 0xffff;
+    uint32_t bits = (uint32_t)w;
+    std::memcpy(&s.depth, &bits, sizeof(bits));
+    return s;
+}
+
+ModMatrix::Destination* ModMatrix::Find(size_t track, uint16_t param) {
+    TrackDests& td = tracks_[track];
+    for (size_t i = 0; i < td.count; ++i) {
+        if (dests_[td.dests[i]].param == param) return &dests_[td.dests[i]];
+    }
+    return nullptr;
+}
+
+bool ModMatrix::GetBase(size_t track, uint16_t param, float* value) const {
+    const TrackDests& td = tracks_[track];
+    for (size_t i = 0; i < td.count; ++i) {
+        if (dests_[td.dests[i]].param == param) {
+            *value = dests_[td.dests[i]].base;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ModMatrix::SetBase(size_t track, uint16_t param, float value, bool immediate) {
+    Destination* d = Find(track, param);
+    if (!d) return false;
+    d->base = d->model->getParameterDesc(param).Clamp(value);
+    if (immediate) {
+        d->value = d->target = d->base;
+        d->increment = 0.0f;
+    }
+    return true;
+}
+
+void ModMatrix::Reset() {
+    numDests_ = 0;
+    for (TrackDests& td : tracks_) td.count = 0;
+    numTicks_ = 0;
+}
+
+void ModMatrix::BeginBlock(const std::vector<std::shared_ptr<DrumModel>>& models, unsigned int frames) {
+    // Find the destinations of the slots; a parameter that is no longer
+    // modulated goes back to its base value
+    bool live[kSlots] = {};
+    for (size_t s = 0; s < kSlots; ++s) {
+        Slot sl = slot(s);
+        if (sl.source < 0 || sl.track >= (int)models.size()) continue;
+        DrumModel& model = *models[sl.track];
+        if (sl.param >= (int)model.getParameterCount()) continue;
+        Destination* d = nullptr;
+        for (size_t i = 0; i < numDests_ && !d; ++i) {
+            if (dests_[i].track == sl.track && dests_[i].param == sl.param) d = &dests_[i];
+        }
+        if (!d) {
+            float value = model.getParameter(sl.param);
+            d = &dests_[numDests_++];
+            *d = {&model, (uint16_t)sl.track, (uint16_t)sl.param, value, value, value, 0.0f};
+        }
+        live[d - dests_] = true;
+    }
+    for (size_t i = numDests_; i-- > 0;) {
+        if (live[i]) continue;
+        dests_[i].model->assignParameter(dests_[i].param, dests_[i].base);
+        dests_[i].model->UpdateCoefficients();
+        dests_[i] = dests_[--numDests_];
+        live[i] = live[numDests_];
+    }
+    for (TrackDests& td : tracks_) {
+        td.count = 0;
+        td.nextTick = 0;
+    }
+    for (size_t i = 0; i < numDests_; ++i) {
+        TrackDests& td = tracks_[dests_[i].track];
+        td.dests[td.count++] = (uint8_t)i;
+    }
+    frames_ = frames;
+    numTicks_ = 0;
+}
+
+void ModMatrix::Trigger(size_t track, unsigned int offset) {
+    if (track >= kTracks) return;
+    AdvanceTo(offset); // a tick on the same sample comes first
+    lfos_[track].Reset();
+}
+
+void ModMatrix::Plan() {
+    if (frames_ > 0) AdvanceTo(frames_ - 1);
+    tickAt_ -= frames_;
+}
+
+// Plans every tick up to and including frame
+void ModMatrix::AdvanceTo(unsigned int frame) {
+    for (; tickAt_ <= frame; tickAt_ += kControlInterval) {
+        for (size_t t = 0; t < kTracks; ++t) {
+            uint32_t w = lfoSettings_[t].load(std::memory_order_relaxed);
+            if (w != appliedLfo_[t]) {
+                LfoSettings s = UnpackLfo(w);
+                plaits::fm::Patch::ModulationParameters m = {};
+                m.rate = (uint8_t)s.rate;
+                m.delay = (uint8_t)s.delay;
+                m.waveform = (uint8_t)s.waveform;
+                m.reset_phase = s.retrigger;
+                lfos_[t].Set(m);
+                appliedLfo_[t] = w;
+            }
+            lfos_[t].Step((float)kControlInterval);
+        }
+        float* mod = mod_[numTicks_];
+        std::fill(mod, mod + numDests_, 0.0f);
+        for (size_t s = 0; s < kSlots; ++s) {
+            Slot sl = slot(s);
+            if (sl.source < 0) continue;
+            for (size_t i = 0; i < numDests_; ++i) {
+                if (dests_[i].track != sl.track || dests_[i].param != sl.param) continue;
+                const plaits::fm::Lfo& lfo = lfos_[sl.source];
+                mod[i] += sl.depth * (2.0f * lfo.value() - 1.0f) * lfo.delay_ramp();
+            }
+        }
+        ticks_[numTicks_++] = tickAt_;
+    }
+}
+
+// Lands the ramps of the previous tick and starts the next ones
+void ModMatrix::ApplyTick(TrackDests& td, size_t tick) {
+    DrumModel* model = nullptr;
+    for (size_t i = 0; i < td.count; ++i) {
+        Destination& d = dests_[td.dests[i]];
+        model = d.model;
+        d.value = d.target;
+        d.model->assignParameter(d.param, d.value);
+        const ParamDesc& desc = d.model->getParameterDesc(d.param);
+        d.target = desc.Denormalize(desc.Normalize(d.base) + mod_[tick][td.dests[i]]);
+        d.increment = (d.target - d.value) / kControlInterval;
+        if (!d.model->isParameterContinuous(d.param)) {
+            d.model->assignParameter(d.param, d.target);
+            d.value = d.target;
+            d.increment = 0.0f;
+        }
+    }
+    if (model) model->UpdateCoefficients();
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "DrumModel.h"
+#include "mi/lfo.h"
+
+// One LFO per track (plaits' DX7 LFO) and a small matrix routing them to
+// model parameters. The matrix runs at control rate: every
+// kControlInterval samples it advances the LFOs, computes each destination
+// as its base value plus modulation along the parameter's curve, and ramps
+// the parameter there over the next interval. Parameters with derived
+// coefficients are updated at control rate only.
+//
+// The LFOs do not depend on the audio, so the control ticks of a block are
+// planned up front; each track then applies its own share while it renders,
+// which lets tracks render on different threads.
+//
+// The GUI writes settings through atomics. Everything else is audio thread
+// only; the base values are what the parameters return to without
+// modulation, so edits and parameter locks go to SetBase.
+class ModMatrix {
+public:
+    static constexpr size_t kTracks = 16;
+    static constexpr size_t kSlots = 8;
+    static constexpr unsigned int kControlInterval = 32;
+    static constexpr unsigned int kMaxBlockFrames = 1024;
+
+    // DX7 ranges: rate and delay 0-99, waveform a plaits::fm::Lfo::Waveform
+    struct LfoSettings {
+        int rate = 35;
+        int delay = 0;
+        int waveform = plaits::fm::Lfo::WAVEFORM_TRIANGLE;
+        bool retrigger = false; // restart the LFO on every hit of its track
+    };
+    struct Slot {
+        int source = -1; // LFO (track) index, -1 when the slot is off
+        int track = 0;
+        int param = 0;
+        float depth = 0.0f; // share of the parameter's range, -1 to 1
+    };
+
+    explicit ModMatrix(float sampleRate);
+
+    // GUI thread
+    void SetLfo(size_t track, const LfoSettings& settings);
+    LfoSettings lfo(size_t track) const;
+    void SetSlot(size_t slot, const Slot& settings);
+    Slot slot(size_t slot) const;
+
+    // Audio thread, before the tracks render a block of up to
+    // kMaxBlockFrames: BeginBlock picks up routing changes, Trigger reports
+    // the block's hits in time order, Plan computes the remaining ticks
+    void BeginBlock(const std::vector<std::shared_ptr<DrumModel>>& models, unsigned int frames);
+    void Trigger(size_t track, unsigned int offset);
+    void Plan();
+    // The kit is about to change: forgets the old models
+    void Reset();
+
+    // Audio thread, per track; tracks may render on different threads.
+    // Step runs once per sample before the track's model.
+    void Step(size_t track, unsigned int frame) {
+        TrackDests& td = tracks_[track];
+        if (td.count == 0) return;
+        if (td.nextTick < numTicks_ && ticks_[td.nextTick] == frame) ApplyTick(td, td.nextTick++);
+        for (size_t i = 0; i < td.count; ++i) {
+            Destination& d = dests_[td.dests[i]];
+            if (d.increment == 0.0f) continue;
+            d.value += d.increment;
+            d.model->assignParameter(d.param, d.value);
+        }
+    }
+    bool GetBase(size_t track, uint16_t param, float* value) const;
+    // False when the parameter is not modulated. With immediate, the running
+    // ramp stops so the caller can set the parameter itself.
+    bool SetBase(size_t track, uint16_t param, float value, bool immediate = false);
+
+private:
+    static constexpr size_t kMaxTicks = kMaxBlockFrames / kControlInterval + 1;
+
+    struct Destination {
+        DrumModel* model;
+        uint16_t track, param;
+        float base;
+        float value, target, increment; // ramp towards the current tick's value
+    };
+    struct TrackDests {
+        size_t count = 0;
+        uint8_t dests[kSlots];
+        size_t nextTick = 0;
+    };
+
+    Destination* Find(size_t track, uint16_t param);
+    void AdvanceTo(unsigned int frame);
+    void ApplyTick(TrackDests& td, size_t tick);
+
+    float sampleRate_;
+    std::atomic<uint32_t> lfoSettings_[kTracks];
+    std::atomic<uint64_t> slots_[kSlots];
+
+    // Audio thread only
+    plaits::fm::Lfo lfos_[kTracks];
+    uint32_t appliedLfo_[kTracks];
+    Destination dests_[kSlots];
+    size_t numDests_ = 0;
+    TrackDests tracks_[kTracks];
+    unsigned int frames_ = 0;
+    unsigned int tickAt_ = 0; // next tick, from the start of the block
+    unsigned int ticks_[kMaxTicks];
+    float mod_[kMaxTicks][kSlots]; // per tick and destination
+    size_t numTicks_ = 0;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "DrumModel.h"
+#include "CustomControls.h"
+
+// One row of a model's parameter table: the member plus its description.
+// The row index is the parameter id.
+template <typename M>
+struct ParamEntry {
+    ParamField<M> field;
+    ParamDesc desc;
+};
+
+// Implements the parameter interface of DrumModel from a static table that
+// M declares as `static const ParamEntry<M> kParams[]` and `kNumParams`
+// (with ParamModel<M> as a friend). Saving, loading, presets and the default
+// controls all walk that table, so a parameter is declared exactly once.
+template <typename M>
+class ParamModel : public DrumModel {
+public:
+    size_t getParameterCount() const override { return M::kNumParams; }
+    const ParamDesc& getParameterDesc(size_t id) const override { return M::kParams[id].desc; }
+
+    float getParameter(size_t id) const override {
+        return id < M::kNumParams ? M::kParams[id].field.get(self()) : 0.0f;
+    }
+
+    void setParameter(size_t id, float value) override {
+        if (id >= M::kNumParams) return;
+        SetField(id, value);
+        UpdateCoefficients();
+    }
+
+    void assignParameter(size_t id, float value) override {
+        if (id < M::kNumParams) SetField(id, value);
+    }
+
+    bool isParameterContinuous(size_t id) const override {
+        return id < M::kNumParams && M::kParams[id].field.f != nullptr;
+    }
+
+    // One line per model, values in id order
+    void saveParameters(std::ostream& os) const override {
+        for (size_t id = 0; id < M::kNumParams; ++id) {
+            if (id) os << ' ';
+            os << getParameter(id);
+        }
+        os << '\n';
+    }
+
+    // Reads one line; values missing from older files keep their current value
+    void loadParameters(std::istream& is) override {
+        std::string line;
+        if (!std::getline(is, line)) return;
+        std::istringstream values(line);
+        float v;
+        for (size_t id = 0; id < M::kNumParams && values >> v; ++id) SetField(id, v);
+        UpdateCoefficients();
+    }
+
+    void RenderControls() override {
+        for (size_t id = 0; id < M::kNumParams; ++id) RenderParameter(id);
+    }
+
+protected:
+    // The table-driven control for one parameter, for models with a custom layout
+    void RenderParameter(size_t id) {
+        const ParamEntry<M>& e = M::kParams[id];
+        M& m = static_cast<M&>(*this);
+        const ParamDesc& d = e.desc;
+        if (e.field.f) {
+            CustomControls::ParameterSlider(d.name, &(m.*e.field.f), d.min, d.max, d.step, d.fast_step,
+                                            d.curve == ParamCurve::Log);
+        } else if (e.field.i) {
+            int step = d.step < 1.0f ? 1 : (int)d.step;
+            int fast_step = d.fast_step < 1.0f ? 1 : (int)d.fast_step;
+            CustomControls::ParameterSliderInt(d.name, &(m.*e.field.i), (int)d.min, (int)d.max, step, fast_step);
+        } else {
+            CustomControls::ParameterCheckbox(d.name, &(m.*e.field.b));
+        }
+    }
+
+private:
+    const M& self() const { return static_cast<const M&>(*this); }
+
+    void SetField(size_t id, float value) {
+        const ParamEntry<M>& e = M::kParams[id];
+        e.field.set(static_cast<M&>(*this), e.desc.Clamp(value));
+    }
+};
@@ -0,0 +1,109 @@
+#include "ParamSaver.h"
+#include "AtomicFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+ParamSnapshot CaptureParams(const std::vector<std::shared_ptr<DrumModel>>& models) {
+    ParamSnapshot snapshot(models.size());
+    for (size_t m = 0; m < models.size(); ++m) {
+        size_t count = models[m]->getParameterCount();
+        snapshot[m].resize(count);
+        for (size_t p = 0; p < count; ++p) snapshot[m][p] = models[m]->getParameter(p);
+    }
+    return snapshot;
+}
+
+std::string FormatParams(const ParamSnapshot& snapshot) {
+    std::ostringstream os;
+    for (const auto& values : snapshot) {
+        for (size_t p = 0; p < values.size(); ++p) {
+            if (p) os << ' ';
+            os << values[p];
+        }
+        os << '\n';
+    }
+    return os.str();
+}
+
+bool ParseParams(const std::string& text, const std::vector<size_t>& counts, ParamSnapshot& out,
+                 std::string* error) {
+    auto fail = [error](size_t line, const std::string& msg) {
+        if (error) *error = "line " + std::to_string(line + 1) + ": " + msg;
+        return false;
+    };
+    std::istringstream is(text);
+    ParamSnapshot snapshot(counts.size());
+    std::string line;
+    for (size_t m = 0; m < counts.size(); ++m) {
+        if (!std::getline(is, line)) return fail(m, "missing");
+        std::istringstream values(line);
+        std::string token;
+        while (values >> token) {
+            char* end = nullptr;
+            float v = std::strtof(token.c_str(), &end);
+            if (*end != '\0' || !std::isfinite(v)) return fail(m, "bad value '" + token + "'");
+            if (snapshot[m].size() == counts[m]) return fail(m, "too many values");
+            snapshot[m].push_back(v);
+        }
+        if (snapshot[m].empty()) return fail(m, "no values");
+    }
+    out = std::move(snapshot);
+    return true;
+}
+
+ParamSaver::ParamSaver() : worker_(&ParamSaver::Run, this) {}
+
+ParamSaver::~ParamSaver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    cv_.notify_one();
+    worker_.join(); // a pending save is still written before exit
+}
+
+void ParamSaver::Save(const std::string& path, ParamSnapshot snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(pending_.begin(), pending_.end(), [&](const Job& job) { return job.path == path; });
+        if (it != pending_.end()) {
+            it->snapshot = std::move(snapshot);
+        } else {
+            pending_.push_back({path, std::move(snapshot)});
+        }
+    }
+    cv_.notify_one();
+}
+
+void ParamSaver::SetWriteHook(std::function<void(const std::string&, const std::string&)> hook) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writeHook_ = std::move(hook);
+}
+
+std::string ParamSaver::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+void ParamSaver::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return !pending_.empty() || quit_; });
+        if (pending_.empty()) return;
+        Job job = std::move(pending_.front());
+        pending_.erase(pending_.begin());
+        auto hook = writeHook_;
+        lock.unlock();
+
+        std::string text = FormatParams(job.snapshot);
+        if (hook) hook(job.path, text);
+        std::string error;
+        bool ok = WriteFileAtomic(job.path, text, &error);
+
+        lock.lock();
+        status_ = ok ? "Saved " + job.path : error;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DrumModel.h"
+
+// Plain copy of every model's parameters, in keyed parameter order
+using ParamSnapshot = std::vector<std::vector<float>>;
+
+// Cheap enough to take under param_mutex: no formatting, no I/O
+ParamSnapshot CaptureParams(const std::vector<std::shared_ptr<DrumModel>>& models);
+// Same text layout as saveParameters, one line per model
+std::string FormatParams(const ParamSnapshot& snapshot);
+// Parses and checks FormatParams text against the expected parameter count of
+// each model. Lines may be shorter (older files) but not longer, and every
+// value must be a finite number. On failure out is untouched.
+bool ParseParams(const std::string& text, const std::vector<size_t>& counts, ParamSnapshot& out,
+                 std::string* error = nullptr);
+
+// Writes parameter snapshots on a background thread (atomic rename + fsync).
+// Save() only queues the snapshot. Each path has one pending slot: a newer
+// request for the same path replaces one that has not started yet, so
+// frequent autosaves never pile up, while saves to different paths (a manual
+// save and an autosave in the same frame) are all written, oldest first.
+class ParamSaver {
+public:
+    ParamSaver();
+    ~ParamSaver();
+
+    void Save(const std::string& path, ParamSnapshot snapshot);
+    std::string status() const;
+    // Called on the writer thread with the exact text, before it is written
+    void SetWriteHook(std::function<void(const std::string& path, const std::string& text)> hook);
+
+private:
+    void Run();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    struct Job {
+        std::string path;
+        ParamSnapshot snapshot;
+    };
+    std::vector<Job> pending_; // at most one per path, oldest first
+    bool quit_ = false;
+    std::string status_;
+    std::function<void(const std::string&, const std::string&)> writeHook_;
+    std::thread worker_;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "DrumModel.h"
+#include "mi/parameter_interpolator.h"
+
+// Ramps parameter edits linearly across one audio block instead of jumping,
+// so live slider moves do not click. Only parameters that changed in this
+// block are ramped; everything else costs nothing. The parameters move every
+// sample, but derived coefficients (exp/pow in most models) are recomputed
+// only every kControlInterval samples and at the end of the block, like the
+// modulation matrix does. Audio thread only.
+class ParamSmoother {
+public:
+    static constexpr size_t kMaxRamps = 64;
+    static constexpr unsigned int kControlInterval = 32; // as ModMatrix
+
+    // Ramps the parameter to value over the next block. False when it cannot
+    // be ramped (not continuous, or too many ramps): set it directly then.
+    bool Ramp(DrumModel& model, uint16_t param, float value) {
+        if (!model.isParameterContinuous(param)) return false;
+        value = model.getParameterDesc(param).Clamp(value);
+        for (size_t i = 0; i < count_; ++i) {
+            if (ramps_[i].model == &model && ramps_[i].param == param) {
+                ramps_[i].target = value;
+                return true;
+            }
+        }
+        if (count_ == kMaxRamps) return false;
+        ramps_[count_++] = {&model, param, model.getParameter(param), value, false};
+        if (std::find(models_, models_ + numModels_, &model) == models_ + numModels_) models_[numModels_++] = &model;
+        return true;
+    }
+
+    void BeginBlock(unsigned int frames) {
+        for (size_t i = 0; i < count_; ++i) interp_[i].emplace(&ramps_[i].state, ramps_[i].target, (size_t)frames);
+        sinceUpdate_ = 0;
+    }
+
+    // Once per sample, before the models run
+    void Step() {
+        if (count_ == 0) return;
+        for (size_t i = 0; i < count_; ++i) {
+            if (!ramps_[i].done) ramps_[i].model->assignParameter(ramps_[i].param, interp_[i]->Next());
+        }
+        if (++sinceUpdate_ == kControlInterval) {
+            sinceUpdate_ = 0;
+            UpdateModels();
+        }
+    }
+
+    // Jumps to the target now, e.g. before a parameter lock takes over
+    void Finish(const DrumModel& model, uint16_t param) {
+        for (size_t i = 0; i < count_; ++i) {
+            Entry& r = ramps_[i];
+            if (r.model != &model || r.param != param || r.done) continue;
+            r.model->assignParameter(r.param, r.target);
+            r.done = true;
+        }
+    }
+
+    // Lands every ramp exactly on its target
+    void EndBlock() {
+        for (size_t i = 0; i < count_; ++i) {
+            interp_[i].reset();
+            if (!ramps_[i].done) ramps_[i].model->assignParameter(ramps_[i].param, ramps_[i].target);
+        }
+        UpdateModels();
+        count_ = 0;
+        numModels_ = 0;
+    }
+
+private:
+    struct Entry {
+        DrumModel* model;
+        uint16_t param;
+        float state;
+        float target;
+        bool done;
+    };
+
+    // One coefficient update per model, however many of its parameters ramp
+    void UpdateModels() {
+        for (size_t i = 0; i < numModels_; ++i) models_[i]->UpdateCoefficients();
+    }
+
+    Entry ramps_[kMaxRamps];
+    std::optional<stmlib::ParameterInterpolator> interp_[kMaxRamps];
+    size_t count_ = 0;
+    DrumModel* models_[kMaxRamps]; // the distinct models in ramps_
+    size_t numModels_ = 0;
+    unsigned int sinceUpdate_ = 0;
+};
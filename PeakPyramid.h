@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Multi-resolution min/max summary of a sliding window of samples, updated
+// incrementally as samples arrive. Level 0 holds the raw samples, level k holds
+// the min/max of blocks of 4^k samples. Samples are addressed by their absolute
+// index since the last Clear(); only the newest kCapacity of them are stored.
+class PeakPyramid {
+public:
+    static constexpr size_t kCapacity = 65536; // power of two
+    static constexpr int kLevels = 8;          // coarsest block = 4^7 samples
+    static constexpr int kLevelShift = 2;      // 4x decimation per level
+
+    void Clear() { total_ = 0; }
+
+    void Push(const float* x, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t idx = total_ + i;
+            float v = x[i];
+            raw_[idx & kMask] = v;
+            for (int k = 1; k < kLevels; ++k) {
+                int shift = k * kLevelShift;
+                size_t slot = (size_t)(idx >> shift) & (kMask >> shift);
+                if ((idx & ((uint64_t(1) << shift) - 1)) == 0) {
+                    min_[k][slot] = v;
+                    max_[k][slot] = v;
+                } else {
+                    min_[k][slot] = std::min(min_[k][slot], v);
+                    max_[k][slot] = std::max(max_[k][slot], v);
+                }
+            }
+        }
+        total_ += n;
+    }
+
+    // Total number of samples pushed since Clear()
+    uint64_t total() const { return total_; }
+    // Absolute index of the oldest sample still available
+    uint64_t first() const { return total_ > kCapacity ? total_ - kCapacity : 0; }
+    float Sample(uint64_t idx) const { return raw_[idx & kMask]; }
+
+    // Min/max of [start, start + count) split into `columns` equal buckets.
+    // Each bucket reads the coarsest level whose block fits inside it, so the
+    // cost is O(columns) regardless of count.
+    void Query(uint64_t start, size_t count, size_t columns, float* mins, float* maxs) const {
+        if (columns == 0) return;
+        double spc = (double)count / (double)columns;
+        int level = 0;
+        while (level + 1 < kLevels && (double)(uint64_t(1) << ((level + 1) * kLevelShift)) <= spc) ++level;
+        int shift = level * kLevelShift;
+        for (size_t c = 0; c < columns; ++c) {
+            uint64_t a = start + (uint64_t)(c * spc);
+            uint64_t b = start + (uint64_t)((c + 1) * spc);
+            if (b <= a) b = a + 1;
+            float lo = 1e30f, hi = -1e30f;
+            for (uint64_t blk = a >> shift; blk <= (b - 1) >> shift; ++blk) {
+                float bl, bh;
+                BlockMinMax(level, blk, bl, bh);
+                lo = std::min(lo, bl);
+                hi = std::max(hi, bh);
+            }
+            mins[c] = lo;
+            maxs[c] = hi;
+        }
+    }
+
+    // First index i in [begin, end) with a sign change between samples i-1
+    // and i (same rule as the old linear scan). Descends the pyramid and only
+    // visits blocks whose min/max straddle zero. Returns end if none found.
+    uint64_t FindZeroCrossing(uint64_t begin, uint64_t end) const {
+        begin = std::max(begin, first() + 1);
+        end = std::min(end, total_);
+        if (begin >= end) return end;
+        int top = kLevels - 1;
+        int shift = top * kLevelShift;
+        for (uint64_t blk = begin >> shift; blk <= (end - 1) >> shift; ++blk) {
+            uint64_t found = Descend(top, blk, begin, end);
+            if (found != end) return found;
+        }
+        return end;
+    }
+
+private:
+    static constexpr size_t kMask = kCapacity - 1;
+
+    static bool Crosses(float prev, float cur) {
+        return (prev <= 0.0f && cur > 0.0f) || (prev >= 0.0f && cur < 0.0f);
+    }
+    static bool MayCross(float lo, float hi) {
+        return (lo <= 0.0f && hi > 0.0f) || (hi >= 0.0f && lo < 0.0f);
+    }
+
+    void BlockMinMax(int level, uint64_t blk, float& lo, float& hi) const {
+        if (level == 0) {
+            lo = hi = raw_[blk & kMask];
+            return;
+        }
+        int shift = level * kLevelShift;
+        size_t slot = (size_t)blk & (kMask >> shift);
+        lo = min_[level][slot];
+        hi = max_[level][slot];
+    }
+
+    uint64_t Descend(int level, uint64_t blk, uint64_t begin, uint64_t end) const {
+        int shift = level * kLevelShift;
+        uint64_t a = std::max(begin, blk << shift);
+        uint64_t b = std::min(end, (blk + 1) << shift);
+        if (a >= b) return end;
+        if (level == 0) {
+            return Crosses(raw_[(a - 1) & kMask], raw_[a & kMask]) ? a : end;
+        }
+        // Include the sample preceding the block so boundary pairs are seen
+        float lo, hi;
+        BlockMinMax(level, blk, lo, hi);
+        float prev = raw_[(a - 1) & kMask];
+        if (!MayCross(std::min(lo, prev), std::max(hi, prev))) return end;
+        int child_shift = (level - 1) * kLevelShift;
+        for (uint64_t c = a >> child_shift; c <= (b - 1) >> child_shift; ++c) {
+            uint64_t found = Descend(level - 1, c, begin, end);
+            if (found != end) return found;
+        }
+        return end;
+    }
+
+    float raw_[kCapacity] = {};
+    float min_[kLevels][kCapacity >> kLevelShift] = {};
+    float max_[kLevels][kCapacity >> kLevelShift] = {};
+    uint64_t total_ = 0;
+};
@@ -0,0 +1,194 @@
+#include "PresetBank.h"
+#include "AtomicFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PresetBank {
+
+static void SetError(std::string* error, const std::string& msg) {
+    if (error) *error = msg;
+}
+
+Kit CaptureKit(const std::string& name, const std::vector<std::shared_ptr<DrumModel>>& models) {
+    Kit kit;
+    kit.name = name;
+    for (size_t m = 0; m < models.size(); ++m) {
+        size_t count = models[m]->getParameterCount();
+        for (size_t p = 0; p < count; ++p) {
+            kit.records.push_back({(uint16_t)m, (uint16_t)p, models[m]->getParameter(p)});
+        }
+    }
+    return kit;
+}
+
+Bank::~Bank() {
+    Close();
+}
+
+bool Bank::Open(const std::string& path, std::string* error) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SetError(error, "cannot open " + path);
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size_t size = (size_t)fileSize.QuadPart;
+    HANDLE mapping = size ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        SetError(error, "cannot map " + path);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        SetError(error, "cannot open " + path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        SetError(error, "empty bank " + path);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping stays valid
+    if (data == MAP_FAILED) {
+        SetError(error, "cannot map " + path);
+        return false;
+    }
+#endif
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = size;
+
+    // Only the header and table sizes are checked here; kits are validated
+    // when they are applied, so opening is O(1) in the number of kits
+    const BankHeader* h = header();
+    if (size_ < sizeof(BankHeader) || std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0) {
+        Close();
+        SetError(error, path + " is not a kit bank");
+        return false;
+    }
+    if (h->version != kVersion) {
+        uint32_t version = h->version;
+        Close();
+        SetError(error, "unsupported bank version " + std::to_string(version));
+        return false;
+    }
+    uint64_t needed = sizeof(BankHeader) + (uint64_t)h->kit_count * sizeof(BankKitEntry)
+                      + (uint64_t)h->record_count * sizeof(BankParamRecord);
+    if (needed > size_) {
+        Close();
+        SetError(error, path + " is truncated");
+        return false;
+    }
+    return true;
+}
+
+void Bank::Close() {
+    if (!data_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle((HANDLE)mapping_);
+    CloseHandle((HANDLE)file_);
+    mapping_ = file_ = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+const BankKitEntry* Bank::entries() const {
+    return reinterpret_cast<const BankKitEntry*>(data_ + sizeof(BankHeader));
+}
+
+const BankParamRecord* Bank::records() const {
+    return reinterpret_cast<const BankParamRecord*>(data_ + sizeof(BankHeader) + header()->kit_count * sizeof(BankKitEntry));
+}
+
+size_t Bank::kitCount() const {
+    return data_ ? header()->kit_count : 0;
+}
+
+std::string Bank::kitName(size_t kit) const {
+    if (kit >= kitCount()) return std::string();
+    const char* name = entries()[kit].name;
+    return std::string(name, strnlen(name, kKitNameSize));
+}
+
+bool Bank::ApplyKit(size_t kit, const std::vector<std::shared_ptr<DrumModel>>& models) const {
+    if (kit >= kitCount()) return false;
+    const BankKitEntry& e = entries()[kit];
+    if ((uint64_t)e.first_record + e.record_count > header()->record_count) return false;
+    const BankParamRecord* r = records() + e.first_record;
+    // Values first, then one coefficient update per model that changed
+    std::vector<char> touched(models.size(), 0);
+    for (uint32_t i = 0; i < e.record_count; ++i) {
+        if (r[i].model_id >= models.size()) continue;
+        DrumModel& model = *models[r[i].model_id];
+        if (r[i].param_id >= model.getParameterCount()) continue;
+        model.assignParameter(r[i].param_id, r[i].value);
+        touched[r[i].model_id] = 1;
+    }
+    for (size_t m = 0; m < models.size(); ++m) {
+        if (touched[m]) models[m]->UpdateCoefficients();
+    }
+    return true;
+}
+
+bool Bank::ReadKit(size_t kit, Kit& out) const {
+    if (kit >= kitCount()) return false;
+    const BankKitEntry& e = entries()[kit];
+    if ((uint64_t)e.first_record + e.record_count > header()->record_count) return false;
+    const BankParamRecord* r = records() + e.first_record;
+    out.name = kitName(kit);
+    out.records.assign(r, r + e.record_count);
+    return true;
+}
+
+bool WriteBank(const std::string& path, const std::vector<Kit>& kits, std::string* error) {
+    BankHeader h;
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.kit_count = (uint32_t)kits.size();
+    h.record_count = 0;
+    std::vector<BankKitEntry> table(kits.size());
+    for (size_t k = 0; k < kits.size(); ++k) {
+        std::memset(table[k].name, 0, kKitNameSize);
+        std::memcpy(table[k].name, kits[k].name.data(), std::min(kits[k].name.size(), kKitNameSize));
+        table[k].first_record = h.record_count;
+        table[k].record_count = (uint32_t)kits[k].records.size();
+        h.record_count += table[k].record_count;
+    }
+
+    std::string data;
+    data.reserve(sizeof(h) + table.size() * sizeof(BankKitEntry) + h.record_count * sizeof(BankParamRecord));
+    data.append(reinterpret_cast<const char*>(&h), sizeof(h));
+    data.append(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(BankKitEntry));
+    for (const Kit& kit : kits) {
+        data.append(reinterpret_cast<const char*>(kit.records.data()), kit.records.size() * sizeof(BankParamRecord));
+    }
+    return WriteFileAtomic(path, data, error);
+}
+
+}
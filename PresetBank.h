@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DrumModel.h"
+
+// Versioned binary kit bank. The file is memory-mapped and read in place:
+// opening only checks the header, and applying a kit walks its records
+// directly from the mapping without any parsing.
+//
+// Layout (little endian, every struct 4-byte aligned):
+//   BankHeader
+//   BankKitEntry[kit_count]
+//   BankParamRecord[record_count]
+// Model ids are the track order in main.cpp and parameter ids come from each
+// model's keyed parameter table. Both are append only, so records for ids a
+// build does not know are skipped, and missing records leave values untouched.
+namespace PresetBank {
+
+constexpr char kMagic[4] = {'F', 'M', 'D', 'B'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kKitNameSize = 32;
+
+struct BankHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t kit_count;
+    uint32_t record_count;
+};
+
+struct BankKitEntry {
+    char name[kKitNameSize];
+    uint32_t first_record;
+    uint32_t record_count;
+};
+
+struct BankParamRecord {
+    uint16_t model_id;
+    uint16_t param_id;
+    float value;
+};
+
+static_assert(sizeof(BankHeader) == 16, "unexpected BankHeader padding");
+static_assert(sizeof(BankKitEntry) == 40, "unexpected BankKitEntry padding");
+static_assert(sizeof(BankParamRecord) == 8, "unexpected BankParamRecord padding");
+
+// A kit captured from live models, ready to be written to a bank
+struct Kit {
+    std::string name;
+    std::vector<BankParamRecord> records;
+};
+
+Kit CaptureKit(const std::string& name, const std::vector<std::shared_ptr<DrumModel>>& models);
+
+class Bank {
+public:
+    Bank() = default;
+    ~Bank();
+    Bank(const Bank&) = delete;
+    Bank& operator=(const Bank&) = delete;
+
+    bool Open(const std::string& path, std::string* error = nullptr);
+    void Close();
+    bool isOpen() const { return data_ != nullptr; }
+
+    size_t kitCount() const;
+    std::string kitName(size_t kit) const;
+    // Writes the kit's records into the models; false if the kit is corrupt
+    bool ApplyKit(size_t kit, const std::vector<std::shared_ptr<DrumModel>>& models) const;
+    // Copies a stored kit back out, e.g. to rewrite the bank with a new kit
+    bool ReadKit(size_t kit, Kit& out) const;
+
+private:
+    const BankHeader* header() const { return reinterpret_cast<const BankHeader*>(data_); }
+    const BankKitEntry* entries() const;
+    const BankParamRecord* records() const;
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+// Writes all kits to path atomically (see WriteFileAtomic)
+bool WriteBank(const std::string& path, const std::vector<Kit>& kits, std::string* error = nullptr);
+
+}
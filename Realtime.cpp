@@ -0,0 +1,99 @@
+#include "Realtime.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+constexpr size_t kPageSize = 4096; // the smallest in use; touching more often is harmless
+
+int ConfigureCurrentThread(int priority, int cpu) {
+#ifdef __linux__
+    if (cpu >= 0) {
+        if (cpu >= CPU_SETSIZE) return EINVAL;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) return err;
+    }
+    if (priority > 0) {
+        sched_param param = {};
+        param.sched_priority = priority;
+        if (int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) return err;
+    }
+    return 0;
+#else
+    return priority > 0 || cpu >= 0 ? ENOTSUP : 0;
+#endif
+}
+
+ThreadSchedule CurrentThreadSchedule() {
+    ThreadSchedule s;
+#ifdef __linux__
+    sched_param param = {};
+    if (pthread_getschedparam(pthread_self(), &s.policy, &param) != 0) return s;
+    s.known = true;
+    s.realtime = s.policy == SCHED_FIFO || s.policy == SCHED_RR;
+    s.priority = param.sched_priority;
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) s.cpus |= uint64_t(1) << cpu;
+        }
+    }
+#endif
+    return s;
+}
+
+std::string DescribeSchedule(const ThreadSchedule& s) {
+    if (!s.known) return "unknown";
+    std::string text;
+#ifdef __linux__
+    switch (s.policy) {
+    case SCHED_FIFO: text = "SCHED_FIFO " + std::to_string(s.priority); break;
+    case SCHED_RR: text = "SCHED_RR " + std::to_string(s.priority); break;
+    default: text = "SCHED_OTHER"; break;
+    }
+#endif
+    // CPU list with runs collapsed: "CPU 2", "CPUs 0-3,6"
+    std::string cpus;
+    int count = 0;
+    for (int cpu = 0; cpu < 64; ++cpu) {
+        if (!((s.cpus >> cpu) & 1)) continue;
+        int last = cpu;
+        while (last + 1 < 64 && ((s.cpus >> (last + 1)) & 1)) ++last;
+        if (!cpus.empty()) cpus += ",";
+        cpus += std::to_string(cpu);
+        if (last > cpu) cpus += "-" + std::to_string(last);
+        count += last - cpu + 1;
+        cpu = last;
+    }
+    if (count > 0) text += (count == 1 ? ", CPU " : ", CPUs ") + cpus;
+    return text;
+}
+
+bool LockProcessMemory(std::string* error) {
+#ifdef __linux__
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) return true;
+    if (error) *error = std::string("mlockall failed: ") + std::strerror(errno);
+#else
+    if (error) *error = "memory locking is only supported on Linux";
+#endif
+    return false;
+}
+
+void PrefaultStack() {
+    volatile char stack[kStackPrefault];
+    for (size_t i = 0; i < kStackPrefault; i += kPageSize) stack[i] = 0;
+    (void)stack[0];
+}
+
+void PrefaultMemory(void* data, size_t bytes) {
+    volatile char* p = static_cast<volatile char*>(data);
+    for (size_t i = 0; i < bytes; i += kPageSize) p[i] = p[i];
+    if (bytes) p[bytes - 1] = p[bytes - 1];
+}
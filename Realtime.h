@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Real-time setup for the audio and render threads. Scheduling, pinning and
+// memory locking are implemented for Linux; elsewhere the requests fail with
+// ENOTSUP and the state reads as unknown.
+
+// Scheduling state of one thread, as the OS reports it
+struct ThreadSchedule {
+    bool known = false;
+    bool realtime = false; // SCHED_FIFO or SCHED_RR
+    int policy = 0;
+    int priority = 0;
+    uint64_t cpus = 0; // affinity over the first 64 CPUs
+};
+
+// Puts the calling thread under SCHED_FIFO at priority (1-99; 0 leaves the
+// policy alone) and pins it to cpu (-1 leaves the affinity alone). Returns
+// 0 or an errno value; does not allocate, so the audio callback may call it.
+int ConfigureCurrentThread(int priority, int cpu);
+ThreadSchedule CurrentThreadSchedule();
+// e.g. "SCHED_FIFO 80, CPU 2" or "SCHED_OTHER, CPUs 0-7"
+std::string DescribeSchedule(const ThreadSchedule& schedule);
+
+// Locks all current and future pages of the process into RAM (mlockall).
+// Needs a memlock limit (ulimit -l) that covers the whole process.
+bool LockProcessMemory(std::string* error = nullptr);
+
+// Touches the next kStackPrefault bytes of the calling thread's stack, so
+// the audio path does not page fault on its first deep call
+constexpr size_t kStackPrefault = 256 * 1024;
+void PrefaultStack();
+// Touches every page of a buffer, keeping its contents
+void PrefaultMemory(void* data, size_t bytes);
@@ -0,0 +1,197 @@
+#include "RenderCache.h"
+#include "DrumKit.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// A hit ends once it has stayed below -80 dBFS for kTailHold seconds; hits
+// still sounding after kMaxLength seconds are left to the live model
+constexpr float kSilence = 1e-4f;
+constexpr float kTailHold = 0.1f;
+constexpr float kMaxLength = 8.0f;
+
+// FNV-1a over the track index and the bit patterns of the values
+static uint64_t HashStep(uint64_t h, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        h ^= (v >> (8 * i)) & 0xff;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint64_t HashValue(uint64_t h, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return HashStep(h, bits);
+}
+
+uint64_t RenderCache::Key(size_t track, const std::vector<float>& params) {
+    uint64_t h = HashStep(14695981039346656037ull, (uint32_t)track);
+    for (float v : params) h = HashValue(h, v);
+    return h;
+}
+
+uint64_t RenderCache::Key(size_t track, const DrumModel& model) {
+    uint64_t h = HashStep(14695981039346656037ull, (uint32_t)track);
+    for (size_t id = 0; id < model.getParameterCount(); ++id) h = HashValue(h, model.getParameter(id));
+    return h;
+}
+
+RenderCache::RenderCache(float sampleRate) : sampleRate_(sampleRate) {
+    for (size_t t = 0; t < kMaxTracks; ++t) {
+        published_[t].store(nullptr);
+        playing_[t].store(nullptr);
+    }
+    worker_ = std::thread(&RenderCache::Run, this);
+}
+
+RenderCache::~RenderCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+}
+
+void RenderCache::SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_ = true;
+    }
+    cv_.notify_one();
+}
+
+void RenderCache::SetBudget(size_t bytes) {
+    budget_.store(bytes, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_ = true;
+    }
+    cv_.notify_one();
+}
+
+void RenderCache::Request(size_t track, uint64_t key, std::vector<float> params) {
+    if (track >= kMaxTracks) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_[track].pending = true;
+        requests_[track].key = key;
+        requests_[track].params = std::move(params);
+        wake_ = true;
+    }
+    cv_.notify_one();
+}
+
+bool RenderCache::StartVoice(size_t track, uint64_t key) {
+    StopVoice(track);
+    const Entry* entry = published_[track].load();
+    if (!entry || entry->key != key || entry->samples.empty()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // Announce the buffer, then make sure it was not unpublished meanwhile:
+    // the worker unpublishes before it checks the hazard slots
+    playing_[track].store(entry);
+    if (published_[track].load() != entry) {
+        playing_[track].store(nullptr);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    voices_[track] = {entry, 0, false};
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void RenderCache::StopVoice(size_t track) {
+    if (!voices_[track].entry) return;
+    voices_[track].entry = nullptr;
+    playing_[track].store(nullptr, std::memory_order_release);
+}
+
+void RenderCache::FadeVoices() {
+    for (Voice& v : voices_) v.fading = true;
+}
+
+void RenderCache::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!quit_) {
+        // Time out now and then: entries pinned by a playing voice are only
+        // evicted once it ends
+        cv_.wait_for(lock, std::chrono::milliseconds(250), [this] { return wake_ || quit_; });
+        if (quit_) break;
+        wake_ = false;
+        PendingRequest work[kMaxTracks];
+        for (size_t t = 0; t < kMaxTracks; ++t) std::swap(work[t], requests_[t]);
+        lock.unlock();
+
+        bool enabled = enabled_.load(std::memory_order_relaxed);
+        for (size_t t = 0; t < kMaxTracks; ++t) {
+            if (!enabled) {
+                published_[t].store(nullptr);
+                continue;
+            }
+            if (!work[t].pending) continue;
+            auto it = cache_.find(work[t].key);
+            Entry* entry = it != cache_.end() ? it->second.get() : RenderHit(t, work[t].key, work[t].params);
+            entry->lastUsed = ++useClock_;
+            published_[t].store(entry);
+        }
+        Evict(enabled ? budget_.load(std::memory_order_relaxed) : 0);
+
+        lock.lock();
+    }
+    lock.unlock();
+    for (size_t t = 0; t < kMaxTracks; ++t) published_[t].store(nullptr);
+}
+
+RenderCache::Entry* RenderCache::RenderHit(size_t track, uint64_t key, const std::vector<float>& params) {
+    auto entry = std::make_unique<Entry>();
+    entry->key = key;
+    std::shared_ptr<DrumModel> model = CreateTrackModel(track);
+    if (model) {
+        for (size_t id = 0; id < params.size() && id < model->getParameterCount(); ++id) model->setParameter(id, params[id]);
+        model->Init();
+        model->Trigger();
+        size_t hold = (size_t)(kTailHold * sampleRate_);
+        size_t maxLength = (size_t)(kMaxLength * sampleRate_);
+        size_t end = 0; // one past the last sample above kSilence
+        std::vector<float>& s = entry->samples;
+        s.reserve((size_t)sampleRate_);
+        while (s.size() < maxLength && s.size() < end + hold) {
+            s.push_back(model->Process());
+            if (std::fabs(s.back()) >= kSilence) end = s.size();
+        }
+        if (s.size() >= maxLength) s.clear(); // still sounding: never cached
+        else s.resize(end);
+        s.shrink_to_fit();
+    }
+    bytes_.fetch_add(entry->samples.size() * sizeof(float), std::memory_order_relaxed);
+    Entry* raw = entry.get();
+    cache_[key] = std::move(entry);
+    entries_.store(cache_.size(), std::memory_order_relaxed);
+    return raw;
+}
+
+bool RenderCache::Pinned(const Entry* entry) const {
+    for (size_t t = 0; t < kMaxTracks; ++t) {
+        if (published_[t].load() == entry || playing_[t].load() == entry) return true;
+    }
+    return false;
+}
+
+void RenderCache::Evict(size_t budget) {
+    while (bytes_.load(std::memory_order_relaxed) > budget || (budget == 0 && !cache_.empty())) {
+        auto victim = cache_.end();
+        for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+            if (Pinned(it->second.get())) continue;
+            if (victim == cache_.end() || it->second->lastUsed < victim->second->lastUsed) victim = it;
+        }
+        if (victim == cache_.end()) break; // everything left is in use
+        bytes_.fetch_sub(victim->second->samples.size() * sizeof(float), std::memory_order_relaxed);
+        cache_.erase(victim);
+    }
+    entries_.store(cache_.size(), std::memory_order_relaxed);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "DrumModel.h"
+
+// Optional cache of pre-rendered one-shots. A background thread renders each
+// track's hit once per parameter set (keyed by a hash of the track and its
+// parameter values) and publishes it; a trigger whose parameters match the
+// published render then plays the buffer instead of running the model.
+// Renders that are not in use are evicted least recently used first once the
+// memory budget is exceeded.
+//
+// Publishing and eviction are lock-free towards the audio thread: a playing
+// voice announces its buffer in a per-track hazard slot, and the worker
+// never frees a buffer that is published or announced.
+class RenderCache {
+public:
+    static constexpr size_t kMaxTracks = 16;
+
+    struct Entry {
+        uint64_t key = 0;
+        std::vector<float> samples; // empty: the hit never decays, play it live
+        uint64_t lastUsed = 0;
+    };
+
+    explicit RenderCache(float sampleRate);
+    ~RenderCache();
+
+    // Identical for the GUI's parameter snapshot and the live model
+    static uint64_t Key(size_t track, const std::vector<float>& params);
+    static uint64_t Key(size_t track, const DrumModel& model);
+
+    // GUI thread
+    void SetEnabled(bool enabled);
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void SetBudget(size_t bytes);
+    // Renders (or re-publishes) the hit for these parameters; a newer request
+    // for the same track replaces one that has not started yet
+    void Request(size_t track, uint64_t key, std::vector<float> params);
+    size_t bytesUsed() const { return bytes_.load(std::memory_order_relaxed); }
+    size_t entryCount() const { return entries_.load(std::memory_order_relaxed); }
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+    // Audio thread. StartVoice plays the published render if its key matches;
+    // otherwise the caller triggers the model as usual.
+    bool StartVoice(size_t track, uint64_t key);
+    void StopVoice(size_t track);
+    bool VoiceActive(size_t track) const { return voices_[track].entry != nullptr; }
+    // Voices playing when the kit changes ring out with the outgoing kit and
+    // take its fade gain, 1 until its tails have to fade
+    void FadeVoices();
+    float Render(size_t track, float fadeGain) {
+        Voice& v = voices_[track];
+        float s = v.entry->samples[v.pos++];
+        if (v.fading) {
+            s *= fadeGain;
+            if (fadeGain <= 0.0f) v.pos = v.entry->samples.size();
+        }
+        if (v.pos == v.entry->samples.size()) StopVoice(track);
+        return s;
+    }
+
+private:
+    struct PendingRequest {
+        bool pending = false;
+        uint64_t key = 0;
+        std::vector<float> params;
+    };
+    struct Voice {
+        const Entry* entry = nullptr;
+        size_t pos = 0;
+        bool fading = false;
+    };
+
+    void Run();
+    Entry* RenderHit(size_t track, uint64_t key, const std::vector<float>& params);
+    void Evict(size_t budget);
+    bool Pinned(const Entry* entry) const;
+
+    float sampleRate_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<size_t> budget_{64u << 20};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool wake_ = false;
+    bool quit_ = false;
+    PendingRequest requests_[kMaxTracks]; // guarded by mutex_
+
+    // Worker thread only
+    std::unordered_map<uint64_t, std::unique_ptr<Entry>> cache_;
+    uint64_t useClock_ = 0;
+
+    std::atomic<const Entry*> published_[kMaxTracks] = {};
+    std::atomic<const Entry*> playing_[kMaxTracks] = {}; // hazard slots
+    Voice voices_[kMaxTracks];                           // audio thread only
+
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> entries_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+
+    std::thread worker_;
+};
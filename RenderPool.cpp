@@ -0,0 +1,90 @@
+#include "RenderPool.h"
+
+#include <chrono>
+
+// Helpers keep spinning for this fraction of the period after their last
+// task, then poll
+constexpr double kSpinFraction = 0.25;
+constexpr auto kPollInterval = std::chrono::microseconds(200);
+
+static uint32_t Range(uint32_t next, uint32_t end) { return next << 16 | end; }
+
+void RenderPool::Start(size_t threads, void (*init)(size_t helper)) {
+    Stop();
+    if (threads < 1) threads = 1;
+    if (threads > kMaxThreads) threads = kMaxThreads;
+    numQueues_ = threads;
+    quit_ = false;
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back([this, i, init] {
+            if (init) init(i - 1);
+            WorkerLoop(i);
+        });
+    }
+}
+
+void RenderPool::Stop() {
+    quit_ = true;
+    for (std::thread& worker : workers_) worker.join();
+    workers_.clear();
+    numQueues_ = 1;
+}
+
+void RenderPool::Run(size_t count, Task task, void* context) {
+    if (workers_.empty() || count < 2) {
+        for (size_t i = 0; i < count; ++i) task(i, context);
+        return;
+    }
+    task_.store(task, std::memory_order_relaxed);
+    context_.store(context, std::memory_order_relaxed);
+    done_.store(0, std::memory_order_relaxed);
+    for (size_t q = 0; q < numQueues_; ++q) {
+        queues_[q].range.store(Range((uint32_t)(q * count / numQueues_), (uint32_t)((q + 1) * count / numQueues_)),
+                               std::memory_order_release);
+    }
+    batch_.fetch_add(1, std::memory_order_release);
+    while (RunOne(0)) {}
+    while (done_.load(std::memory_order_acquire) < count) std::this_thread::yield();
+}
+
+void RenderPool::SetPeriod(double seconds) {
+    spinNanos_.store((int64_t)(seconds * kSpinFraction * 1e9), std::memory_order_relaxed);
+}
+
+bool RenderPool::RunOne(size_t self) {
+    for (size_t k = 0; k < numQueues_; ++k) {
+        std::atomic<uint32_t>& range = queues_[(self + k) % numQueues_].range;
+        uint32_t r = range.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t next = r >> 16, end = r & 0xffff;
+            if (next >= end) break;
+            // The own queue is taken from the front, the others from the back
+            uint32_t index = k == 0 ? next : end - 1;
+            uint32_t claimed = k == 0 ? Range(next + 1, end) : Range(next, end - 1);
+            if (range.compare_exchange_weak(r, claimed, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                task_.load(std::memory_order_relaxed)(index, context_.load(std::memory_order_relaxed));
+                done_.fetch_add(1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void RenderPool::WorkerLoop(size_t self) {
+    uint64_t seen = batch_.load(std::memory_order_acquire);
+    auto lastWork = std::chrono::steady_clock::now();
+    while (!quit_.load(std::memory_order_relaxed)) {
+        uint64_t batch = batch_.load(std::memory_order_acquire);
+        if (batch != seen) {
+            seen = batch;
+            while (RunOne(self)) {}
+            lastWork = std::chrono::steady_clock::now();
+        } else if (std::chrono::steady_clock::now() - lastWork <
+                   std::chrono::nanoseconds(spinNanos_.load(std::memory_order_relaxed))) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(kPollInterval);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Helper threads for the audio callback. Run() deals a batch of tasks out
+// into one queue per thread, the calling thread included; every thread
+// drains its own queue from the front and then steals from the back of the
+// others. Claiming a task is a single compare-and-swap.
+//
+// The caller never waits for a helper to wake up: whatever nobody has
+// claimed yet it runs itself, and it only spins for tasks another thread
+// is already running. Helpers spin for a quarter of the callback period
+// after each batch, which keeps them awake across the chunks of a block,
+// and then sleep between polls. So they leave their cores free between
+// blocks even at the smallest buffer sizes, and an idle pool costs next to
+// nothing.
+class RenderPool {
+public:
+    static constexpr size_t kMaxThreads = 16; // including the calling thread
+    using Task = void (*)(size_t index, void* context);
+
+    RenderPool() = default;
+    ~RenderPool() { Stop(); }
+
+    // threads counts the calling thread: 1 runs every task inline. Each
+    // helper runs init(0 .. threads-2) first, e.g. to set its scheduling.
+    void Start(size_t threads, void (*init)(size_t helper) = nullptr);
+    void Stop();
+    size_t threadCount() const { return workers_.size() + 1; }
+
+    // Audio thread: runs task(0 .. count-1, context) and returns once all
+    // of them are done
+    void Run(size_t count, Task task, void* context);
+    // Audio thread: the length of one callback period, which sets how long
+    // helpers spin
+    void SetPeriod(double seconds);
+
+private:
+    // Task range of one queue: next << 16 | end
+    struct alignas(64) Queue {
+        std::atomic<uint32_t> range{0};
+    };
+
+    bool RunOne(size_t self);
+    void WorkerLoop(size_t self);
+
+    Queue queues_[kMaxThreads];
+    size_t numQueues_ = 1;
+    std::atomic<Task> task_{nullptr};
+    std::atomic<void*> context_{nullptr};
+    alignas(64) std::atomic<size_t> done_{0};
+    alignas(64) std::atomic<uint64_t> batch_{0};
+    std::atomic<bool> quit_{false};
+    std::atomic<int64_t> spinNanos_{1000000};
+    std::vector<std::thread> workers_;
+};
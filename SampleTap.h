@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// The newest samples of a stream, for display. One writer (the audio thread)
+// appends without locking or allocating; a reader copies out the latest
+// window and is told when the writer overwrote it during the copy. N must
+// be a power of two.
+template <size_t N>
+class SampleTap {
+    static_assert((N & (N - 1)) == 0, "SampleTap size must be a power of two");
+
+public:
+    void Write(const float* x, size_t count) {
+        uint64_t w = written_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) samples_[(w + i) & (N - 1)].store(x[i], std::memory_order_relaxed);
+        written_.store(w + count, std::memory_order_release);
+    }
+
+    // Copies the newest count samples (count <= N / 2); false until that
+    // many have been written, or when the copy was overwritten
+    bool ReadLatest(float* out, size_t count) const {
+        uint64_t end = written_.load(std::memory_order_acquire);
+        if (end < count) return false;
+        uint64_t start = end - count;
+        for (size_t i = 0; i < count; ++i) out[i] = samples_[(start + i) & (N - 1)].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return written_.load(std::memory_order_relaxed) - start <= N;
+    }
+
+private:
+    std::atomic<float> samples_[N] = {};
+    alignas(64) std::atomic<uint64_t> written_{0};
+};
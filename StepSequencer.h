@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+constexpr size_t kMaxStepLocks = 4;
+
+// Parameter overrides carried by one sequenced trigger (Machinedrum-style
+// parameter locks). Plain values, copied into the trigger schedule.
+struct ParamLock {
+    uint16_t param;
+    float value;
+};
+struct StepLocks {
+    size_t count = 0;
+    ParamLock locks[kMaxStepLocks];
+};
+
+// Pattern sequencer run by the audio callback. Steps are sixteenth notes;
+// their positions are kept as fractional sample offsets, so triggers land on
+// the exact sample whatever the block size, tempo or swing.
+//
+// The GUI edits the pattern through atomics (one bit per step, one word per
+// parameter lock), so neither side ever waits. Lock slots are preallocated
+// for every step. Tempo, swing and length changes take effect on the next
+// step.
+class StepSequencer {
+public:
+    static constexpr size_t kTracks = 16;
+    static constexpr int kMaxSteps = 64;
+
+    explicit StepSequencer(float sampleRate) : sampleRate_(sampleRate) {}
+
+    // GUI thread
+    void SetStep(size_t track, int step, bool on) {
+        uint64_t bit = uint64_t(1) << step;
+        if (on) steps_[track].fetch_or(bit, std::memory_order_relaxed);
+        else steps_[track].fetch_and(~bit, std::memory_order_relaxed);
+    }
+    bool step(size_t track, int step) const {
+        return (steps_[track].load(std::memory_order_relaxed) >> step) & 1;
+    }
+
+    // Up to kMaxStepLocks parameter locks per step; SetLock fails on a full step
+    bool SetLock(size_t track, int step, uint16_t param, float value) {
+        std::atomic<uint64_t>* slots = locks_[track][step];
+        size_t free = kMaxStepLocks;
+        for (size_t i = 0; i < kMaxStepLocks; ++i) {
+            uint64_t w = slots[i].load(std::memory_order_relaxed);
+            if ((w & kUsed) && Param(w) == param) {
+                slots[i].store(Pack(param, value), std::memory_order_relaxed);
+                return true;
+            }
+            if (!(w & kUsed) && free == kMaxStepLocks) free = i;
+        }
+        if (free == kMaxStepLocks) return false;
+        slots[free].store(Pack(param, value), std::memory_order_relaxed);
+        return true;
+    }
+    void ClearLock(size_t track, int step, uint16_t param) {
+        for (std::atomic<uint64_t>& slot : locks_[track][step]) {
+            uint64_t w = slot.load(std::memory_order_relaxed);
+            if ((w & kUsed) && Param(w) == param) slot.store(0, std::memory_order_relaxed);
+        }
+    }
+    bool lock(size_t track, int step, uint16_t param, float* value) const {
+        for (const std::atomic<uint64_t>& slot : locks_[track][step]) {
+            uint64_t w = slot.load(std::memory_order_relaxed);
+            if ((w & kUsed) && Param(w) == param) {
+                *value = Value(w);
+                return true;
+            }
+        }
+        return false;
+    }
+    StepLocks locks(size_t track, int step) const {
+        StepLocks out;
+        for (const std::atomic<uint64_t>& slot : locks_[track][step]) {
+            uint64_t w = slot.load(std::memory_order_relaxed);
+            if (w & kUsed) out.locks[out.count++] = {Param(w), Value(w)};
+        }
+        return out;
+    }
+
+    void SetTempo(float bpm) { bpm_.store(bpm < 20.0f ? 20.0f : (bpm > 300.0f ? 300.0f : bpm), std::memory_order_relaxed); }
+    float tempo() const { return bpm_.load(std::memory_order_relaxed); }
+    // Share of a step pair taken by its first step: 0.5 is straight, 0.75 is
+    // a dotted-eighth feel (the Machinedrum's 50-80% swing)
+    void SetSwing(float swing) { swing_.store(swing < 0.5f ? 0.5f : (swing > 0.8f ? 0.8f : swing), std::memory_order_relaxed); }
+    float swing() const { return swing_.load(std::memory_order_relaxed); }
+    void SetLength(int steps) { length_.store(steps < 1 ? 1 : (steps > kMaxSteps ? kMaxSteps : steps), std::memory_order_relaxed); }
+    int length() const { return length_.load(std::memory_order_relaxed); }
+
+    void Start() { restart_.store(true, std::memory_order_relaxed); running_.store(true, std::memory_order_release); }
+    void Stop() { running_.store(false, std::memory_order_release); }
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+    // Step that last played, -1 while stopped
+    int currentStep() const { return current_.load(std::memory_order_relaxed); }
+
+    // Audio thread, once per block: calls emit(offset, track, locks) for
+    // every trigger in the next nFrames samples, in time order
+    template <typename Emit>
+    void Advance(unsigned int nFrames, Emit&& emit) {
+        if (!isRunning()) {
+            current_.store(-1, std::memory_order_relaxed);
+            return;
+        }
+        if (restart_.exchange(false, std::memory_order_relaxed)) {
+            next_ = 0;
+            nextAt_ = 0.0;
+            offbeat_ = false;
+        }
+        while (nextAt_ < nFrames) {
+            // A pattern shortened behind the playhead wraps it at once, so
+            // no step beyond the new end plays
+            int stepCount = length();
+            if (stepCount != appliedLength_) {
+                next_ %= stepCount;
+                appliedLength_ = stepCount;
+            }
+            int step = next_;
+            unsigned int offset = (unsigned int)nextAt_;
+            for (size_t t = 0; t < kTracks; ++t) {
+                if ((steps_[t].load(std::memory_order_relaxed) >> step) & 1) emit(offset, t, locks(t, step));
+            }
+            current_.store(step, std::memory_order_relaxed);
+            nextAt_ += StepLength(offbeat_);
+            offbeat_ = !offbeat_;
+            next_ = step + 1 >= stepCount ? 0 : step + 1;
+        }
+        nextAt_ -= nFrames;
+    }
+
+private:
+    // Lock word: used flag, parameter id, float bits
+    static constexpr uint64_t kUsed = uint64_t(1) << 63;
+    static uint64_t Pack(uint16_t param, float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return kUsed | (uint64_t)param << 32 | bits;
+    }
+    static uint16_t Param(uint64_t w) { return (uint16_t)(w >> 32); }
+    static float Value(uint64_t w) {
+        uint32_t bits = (uint32_t)w;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Samples from the start of this step to the next one
+    double StepLength(bool offbeat) const {
+        double pair = 2.0 * 60.0 / (4.0 * tempo()) * sampleRate_;
+        double even = pair * swing();
+        return offbeat ? pair - even : even;
+    }
+
+    float sampleRate_;
+    std::atomic<uint64_t> steps_[kTracks] = {};
+    std::atomic<uint64_t> locks_[kTracks][kMaxSteps][kMaxStepLocks] = {};
+    std::atomic<float> bpm_{120.0f};
+    std::atomic<float> swing_{0.5f};
+    std::atomic<int> length_{16};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> restart_{false};
+    std::atomic<int> current_{-1};
+
+    // Audio thread only
+    int next_ = 0;
+    int appliedLength_ = 16; // length next_ was counted with
+    double nextAt_ = 0.0; // samples from the start of the current block
+    // Second step of a swing pair. Counted over played steps rather than
+    // taken from the step index, so odd lengths keep alternating across
+    // the loop point.
+    bool offbeat_ = false;
+};
@@ -1,13 +1,16 @@
 #include "TRXBassDrum.h"
-#include "imgui.h"
 #include <cmath>
 #include <algorithm>
 
 constexpr float kSampleRate = 48000.0f;
+// Seeded once in Init(): a fresh model, as the render cache uses, renders the
+// same hit every time, while live hits keep running through the sequence
+constexpr uint32_t kNoiseSeed = 0xba55d5;
 
 void TRXBassDrum::Init() {
     phase = t = env = rampEnv = 0.0f;
     prevSample = 0.0f;
+    noiseSource.Seed(kNoiseSeed);
 }
 
 void TRXBassDrum::Trigger() {
@@ -17,14 +20,19 @@ void TRXBassDrum::Trigger() {
     phase = 0.0f;
 }
 
+void TRXBassDrum::UpdateCoefficients() {
+    envDecay = std::exp(-1.0f / (decay * kSampleRate));
+    rampEnvDecay = std::exp(-1.0f / (rampDecay * kSampleRate));
+}
+
 float TRXBassDrum::Process() {
     if (env <= 0.0001f) return 0.0f;
 
     t += 1.0f / kSampleRate;
 
     // Envelope decay
-    env *= std::exp(-1.0f / (decay * kSampleRate));
-    rampEnv *= std::exp(-1.0f / (rampDecay * kSampleRate));
+    env *= envDecay;
+    rampEnv *= rampEnvDecay;
 
     // Frequency modulation
     float freq = pitch + ramp * rampEnv * 1000.0f;
@@ -41,7 +49,7 @@ float TRXBassDrum::Process() {
 
     // Add noise burst
     if (noise > 0.0f && t < 0.01f) {
-        value += noise * ((rand() / (float)RAND_MAX) * 2.0f - 1.0f) * env;
+        value += noise * noiseSource.Next() * env;
     }
 
     // Soft clip
@@ -52,17 +60,21 @@ float TRXBassDrum::Process() {
     return value;
 }
 
-void TRXBassDrum::RenderControls() {
-    ImGui::SliderFloat("Pitch", &pitch, 20.0f, 120.0f);
-    ImGui::SliderFloat("Decay", &decay, 0.01f, 2.0f);
-    ImGui::SliderFloat("Ramp", &ramp, 0.0f, 1.0f);
-    ImGui::SliderFloat("Ramp Decay", &rampDecay, 0.01f, 1.0f);
-    ImGui::SliderFloat("Start", &start, 0.0f, 2.0f);
-    ImGui::SliderFloat("Noise", &noise, 0.0f, 1.0f);
-    ImGui::SliderFloat("Harmonics", &harmonics, 0.0f, 1.0f);
-    ImGui::SliderFloat("Clip", &clip, 0.0f, 1.0f);
-}
 
 float TRXBassDrum::sine(float x) {
     return std::sin(x); // Replace with lookup if performance becomes a concern
 }
+
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<TRXBassDrum> TRXBassDrum::kParams[] = {
+    {&TRXBassDrum::pitch, {"Pitch", 20.0f, 120.0f, 50.0f, ParamCurve::Log}},
+    {&TRXBassDrum::decay, {"Decay", 0.01f, 2.0f, 0.4f, ParamCurve::Log}},
+    {&TRXBassDrum::ramp, {"Ramp", 0.0f, 1.0f, 0.3f}},
+    {&TRXBassDrum::rampDecay, {"Ramp Decay", 0.01f, 1.0f, 0.1f, ParamCurve::Log}},
+    {&TRXBassDrum::start, {"Start", 0.0f, 2.0f, 1.0f}},
+    {&TRXBassDrum::noise, {"Noise", 0.0f, 1.0f, 0.0f}},
+    {&TRXBassDrum::harmonics, {"Harmonics", 0.0f, 1.0f, 0.0f}},
+    {&TRXBassDrum::clip, {"Clip", 0.0f, 1.0f, 0.0f}}
+};
+const size_t TRXBassDrum::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
@@ -1,32 +1,29 @@
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
+#include "WhiteNoise.h"
 
-class TRXBassDrum : public DrumModel {
+class TRXBassDrum : public ParamModel<TRXBassDrum> {
 public:
+    TRXBassDrum() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float Process() override;
-    void RenderControls() override;
-
-    void saveParameters(std::ostream& os) const override {
-        os << pitch << ' ' << decay << ' ' << ramp << ' ' << rampDecay << ' '
-           << start << ' ' << noise << ' ' << harmonics << ' ' << clip << '\n';
-    }
-
-    void loadParameters(std::istream& is) override {
-        is >> pitch >> decay >> ramp >> rampDecay >> start >> noise >> harmonics >> clip;
-    }
+    void UpdateCoefficients() override;
 
 private:
-    // User parameters
-    float pitch = 50.0f;       // Base pitch in Hz
-    float decay = 0.4f;        // Envelope decay time
-    float ramp = 0.3f;         // Frequency ramp amount
-    float rampDecay = 0.1f;    // Ramp decay time
-    float start = 1.0f;        // Start amplitude multiplier
-    float noise = 0.0f;        // Noise at attack
-    float harmonics = 0.0f;    // Adds clipped harmonic content
-    float clip = 0.0f;         // Soft clipping amount
+    friend class ParamModel<TRXBassDrum>;
+    static const ParamEntry<TRXBassDrum> kParams[];
+    static const size_t kNumParams;
+
+    // User parameters (defaults in kParams)
+    float pitch;       // Base pitch in Hz
+    float decay;       // Envelope decay time
+    float ramp;        // Frequency ramp amount
+    float rampDecay;   // Ramp decay time
+    float start;       // Start amplitude multiplier
+    float noise;       // Noise at attack
+    float harmonics;   // Adds clipped harmonic content
+    float clip;        // Soft clipping amount
 
     // Internal state
     float phase = 0.0f;
@@ -35,6 +32,12 @@ private:
     float rampEnv = 0.0f;
     float prevSample = 0.0f;
 
+    // Per-sample decay factors, from UpdateCoefficients()
+    float envDecay = 0.0f;
+    float rampEnvDecay = 0.0f;
+
+    WhiteNoise noiseSource;
+
     // Helpers
     float sine(float x);
 };
@@ -1,5 +1,4 @@
 #include "TRXClaves.h"
-#include "imgui.h"
 #include <cmath>
 #include <algorithm>
 
@@ -17,11 +16,15 @@ void TRXClaves::Trigger() {
     phase1 = phase2 = 0.0f;
 }
 
+void TRXClaves::UpdateCoefficients() {
+    envDecay = std::exp(-1.0f / (decay * kSampleRate));
+}
+
 float TRXClaves::Process() {
     if (env < 0.0001f) return 0.0f;
 
     t += 1.0f / kSampleRate;
-    env *= std::exp(-1.0f / (decay * kSampleRate));
+    env *= envDecay;
 
     phase1 += pitch / kSampleRate;
     phase2 += (pitch + interval) / kSampleRate;
@@ -40,14 +43,18 @@ float TRXClaves::Process() {
     return out;
 }
 
-void TRXClaves::RenderControls() {
-    ImGui::SliderFloat("Pitch", &pitch, 200.0f, 4000.0f);
-    ImGui::SliderFloat("Interval", &interval, 0.0f, 400.0f);
-    ImGui::SliderFloat("Decay", &decay, 0.01f, 0.5f);
-    ImGui::SliderFloat("Balance", &balance, 0.0f, 1.0f);
-    ImGui::SliderFloat("Clip", &clip, 0.0f, 1.0f);
-}
 
 float TRXClaves::sine(float x) {
     return std::sin(x);
 }
+
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<TRXClaves> TRXClaves::kParams[] = {
+    {&TRXClaves::pitch, {"Pitch", 200.0f, 4000.0f, 600.0f, ParamCurve::Log}},
+    {&TRXClaves::interval, {"Interval", 0.0f, 400.0f, 200.0f}},
+    {&TRXClaves::decay, {"Decay", 0.01f, 0.5f, 0.1f, ParamCurve::Log}},
+    {&TRXClaves::balance, {"Balance", 0.0f, 1.0f, 0.5f}},
+    {&TRXClaves::clip, {"Clip", 0.0f, 1.0f, 0.2f}}
+};
+const size_t TRXClaves::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
@@ -1,33 +1,31 @@
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
 
-class TRXClaves : public DrumModel {
+class TRXClaves : public ParamModel<TRXClaves> {
 public:
+    TRXClaves() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float Process() override;
-    void RenderControls() override;
-
-    void saveParameters(std::ostream& os) const override {
-        os << pitch << ' ' << interval << ' ' << decay
-           << ' ' << balance << ' ' << clip << '\n';
-    }
-
-    void loadParameters(std::istream& is) override {
-        is >> pitch >> interval >> decay >> balance >> clip;
-    }
+    void UpdateCoefficients() override;
 
 private:
-    float pitch = 600.0f;     // Base pitch (Hz)
-    float interval = 200.0f;  // Interval between the two oscillators
-    float decay = 0.1f;       // Envelope decay
-    float balance = 0.5f;     // Balance between osc1 and osc2
-    float clip = 0.2f;        // Clipping/saturation
+    friend class ParamModel<TRXClaves>;
+    static const ParamEntry<TRXClaves> kParams[];
+    static const size_t kNumParams;
+
+    // Parameters (defaults in kParams)
+    float pitch;     // Base pitch (Hz)
+    float interval;  // Interval between the two oscillators
+    float decay;     // Envelope decay
+    float balance;   // Balance between osc1 and osc2
+    float clip;      // Clipping/saturation
 
     float phase1 = 0.0f;
     float phase2 = 0.0f;
     float env = 0.0f;
     float t = 0.0f;
+    float envDecay = 0.0f; // per-sample, from UpdateCoefficients()
 
     float sine(float x);
 };
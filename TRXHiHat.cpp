@@ -1,14 +1,17 @@
 #include "TRXHiHat.h"
-#include "imgui.h"
 #include <cmath>
 
 constexpr float kSampleRate = 48000.0f; // Adjust to match your engine
+// Seeded once in Init(): a fresh model, as the render cache uses, renders the
+// same hit every time, while live hits keep running through the sequence
+constexpr uint32_t kNoiseSeed = 0x4a7;
 
 void TRXHiHat::Init() {
-    rng.seed(std::random_device{}());
     env = 0.0f;
     t = 0.0f;
     lp_y = hp_y = hp_x = 0.0f;
+    for (float& p : phase) p = 0.0f;
+    noiseSource.Seed(kNoiseSeed);
 }
 
 void TRXHiHat::Trigger() {
@@ -20,6 +23,12 @@ float TRXHiHat::get_value(const float fadeTime){
     return fadeTime;
 }
 
+void TRXHiHat::UpdateCoefficients() {
+    lpfAlpha = std::exp(-2.0f * M_PI * lpfFreq / kSampleRate);
+    hpfAlpha = std::exp(-2.0f * M_PI * hpfFreq / kSampleRate);
+    envDecay = std::exp(-1.0f / (decay * kSampleRate));
+}
+
 float TRXHiHat::Process() {
     constexpr float fadeTime = 0.005f; // 5 ms crossfade
     t += 1.0f / kSampleRate;
@@ -30,17 +39,15 @@ float TRXHiHat::Process() {
     float n = generateMetallicNoise();
 
     // Apply low-pass filter
-    float lpfAlpha = std::exp(-2.0f * M_PI * lpfFreq / kSampleRate);
     lp_y = (1.0f - lpfAlpha) * n + lpfAlpha * lp_y;
 
     // Apply high-pass filter
-    float hpfAlpha = std::exp(-2.0f * M_PI * hpfFreq / kSampleRate);
     float hp = hpfAlpha * (hp_y + lp_y - hp_x);
     hp_y = lp_y;
     hp_x = hp;
 
     // Envelope decay
-    env *= std::exp(-1.0f / (decay * kSampleRate));
+    env *= envDecay;
 
     // GAP crossfade
     if (t > gap) {
@@ -58,19 +65,10 @@ float TRXHiHat::Process() {
 }
 
 
-void TRXHiHat::RenderControls() {
-    ImGui::SliderFloat("Gap", &gap, 0.0f, 1.0f);
-    ImGui::SliderFloat("Decay", &decay, 0.01f, 1.0f);
-    ImGui::SliderFloat("LPF Freq", &lpfFreq, 1000.0f, 12000.0f);
-    ImGui::SliderFloat("HPF Freq", &hpfFreq, 100.0f, 10000.0f);
-    ImGui::SliderFloat("Peak", &peak, 0.0f, 1.0f);
-    ImGui::SliderFloat("Metal", &metal, 0.0f, 1.0f);
-}
 
 float TRXHiHat::generateMetallicNoise() {
     // Square wave harmonic mix — crude but efficient
     float result = 0.0f;
-    static float phase[6] = { 0 };
     static const float freqs[6] = { 306.0f, 512.0f, 551.0f, 743.0f, 826.0f, 900.0f };
 
     for (int i = 0; i < 6; ++i) {
@@ -79,6 +77,18 @@ float TRXHiHat::generateMetallicNoise() {
         result += (phase[i] < 0.5f ? 1.0f : -1.0f);
     }
 
-    float white = noiseDist(rng);
+    float white = noiseSource.Next();
     return metal * (result / 6.0f) + (1.0f - metal) * white;
 }
+
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<TRXHiHat> TRXHiHat::kParams[] = {
+    {&TRXHiHat::gap, {"Gap", 0.0f, 1.0f, 0.5f}},
+    {&TRXHiHat::decay, {"Decay", 0.01f, 1.0f, 0.2f, ParamCurve::Log}},
+    {&TRXHiHat::lpfFreq, {"LPF Freq", 1000.0f, 12000.0f, 8000.0f, ParamCurve::Log}},
+    {&TRXHiHat::hpfFreq, {"HPF Freq", 100.0f, 10000.0f, 4000.0f, ParamCurve::Log}},
+    {&TRXHiHat::peak, {"Peak", 0.0f, 1.0f, 0.5f}},
+    {&TRXHiHat::metal, {"Metal", 0.0f, 1.0f, 0.7f}}
+};
+const size_t TRXHiHat::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
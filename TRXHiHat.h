@@ -1,33 +1,29 @@
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
+#include "WhiteNoise.h"
 #include <array>
-#include <random>
 
-class TRXHiHat : public DrumModel {
+class TRXHiHat : public ParamModel<TRXHiHat> {
 public:
+    TRXHiHat() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float get_value(float fadeTime);
     float Process() override;
-    void RenderControls() override;
-
-    void saveParameters(std::ostream& os) const override {
-        os << gap << ' ' << decay << ' ' << lpfFreq << ' '
-           << hpfFreq << ' ' << peak << ' ' << metal << '\n';
-    }
-
-    void loadParameters(std::istream& is) override {
-        is >> gap >> decay >> lpfFreq >> hpfFreq >> peak >> metal;
-    }
+    void UpdateCoefficients() override;
 
 private:
-    // Parameters
-    float gap = 0.5f;
-    float decay = 0.2f;
-    float lpfFreq = 8000.0f;
-    float hpfFreq = 4000.0f;
-    float peak = 0.5f;
-    float metal = 0.7f;
+    friend class ParamModel<TRXHiHat>;
+    static const ParamEntry<TRXHiHat> kParams[];
+    static const size_t kNumParams;
+
+    // Parameters (defaults in kParams)
+    float gap;
+    float decay;
+    float lpfFreq;
+    float hpfFreq;
+    float peak;
+    float metal;
 
     // Envelope
     float env = 0.0f;
@@ -38,9 +34,14 @@ private:
     float hp_y = 0.0f;
     float hp_x = 0.0f;
 
-    // Noise source
-    std::default_random_engine rng;
-    std::uniform_real_distribution<float> noiseDist{-1.0f, 1.0f};
+    // Filter and decay coefficients, from UpdateCoefficients()
+    float lpfAlpha = 0.0f;
+    float hpfAlpha = 0.0f;
+    float envDecay = 0.0f;
+
+    // Noise source: six free-running square waves and white noise
+    float phase[6] = {};
+    WhiteNoise noiseSource;
 
     float generateMetallicNoise();
 };
@@ -1,14 +1,17 @@
 #include "TRXSnareDrum.h"
-#include "imgui.h"
 #include <cmath>
 #include <algorithm>
 
 constexpr float kSampleRate = 48000.0f;
+// Seeded once in Init(): a fresh model, as the render cache uses, renders the
+// same hit every time, while live hits keep running through the sequence
+constexpr uint32_t kNoiseSeed = 0x5a4e;
 
 void TRXSnareDrum::Init() {
     t = ampEnv = snapEnv = 0.0f;
     phase1 = phase2 = 0.0f;
     hp_x = hp_y = 0.0f;
+    noiseSource.Seed(kNoiseSeed);
 }
 
 void TRXSnareDrum::Trigger() {
@@ -18,14 +21,20 @@ void TRXSnareDrum::Trigger() {
     phase1 = phase2 = 0.0f;
 }
 
+void TRXSnareDrum::UpdateCoefficients() {
+    ampDecay = std::exp(-1.0f / (decay * kSampleRate));
+    snapDecay = std::exp(-1.0f / (0.02f * kSampleRate)); // 20ms snap noise decay
+    hp_a = std::exp(-2.0f * M_PI * 400.0f / kSampleRate);
+}
+
 float TRXSnareDrum::Process() {
     if (ampEnv <= 0.0001f) return 0.0f;
 
     t += 1.0f / kSampleRate;
 
     // Decay envelopes
-    ampEnv *= std::exp(-1.0f / (decay * kSampleRate));
-    snapEnv *= std::exp(-1.0f / (0.02f * kSampleRate)); // 20ms snap noise decay
+    ampEnv *= ampDecay;
+    snapEnv *= snapDecay;
 
     // Oscillators (tuned with interval)
     float freq1 = pitch + bump * 80.0f;
@@ -42,11 +51,10 @@ float TRXSnareDrum::Process() {
     float tonePart = (tone * osc1 + (1.0f - tone) * osc2) * ampEnv;
 
     // Snap noise burst
-    float snapNoise = ((rand() / (float)RAND_MAX) * 2.0f - 1.0f) * snap * snapEnv;
+    float snapNoise = noiseSource.Next() * snap * snapEnv;
 
     // Sustained filtered noise (high-pass)
-    float rawNoise = ((rand() / (float)RAND_MAX) * 2.0f - 1.0f);
-    float hp_a = std::exp(-2.0f * M_PI * 400.0f / kSampleRate);
+    float rawNoise = noiseSource.Next();
     float hp = hp_a * (hp_y + rawNoise - hp_x);
     hp_y = rawNoise;
     hp_x = hp;
@@ -64,17 +72,21 @@ float TRXSnareDrum::Process() {
     return out;
 }
 
-void TRXSnareDrum::RenderControls() {
-    ImGui::SliderFloat("Pitch", &pitch, 60.0f, 400.0f);
-    ImGui::SliderFloat("Decay", &decay, 0.05f, 1.0f);
-    ImGui::SliderFloat("Snap", &snap, 0.0f, 1.0f);
-    ImGui::SliderFloat("Noise", &noise, 0.0f, 1.0f);
-    ImGui::SliderFloat("Tone Balance", &tone, 0.0f, 1.0f);
-    ImGui::SliderFloat("Tune Interval", &tune, 0.0f, 400.0f);
-    ImGui::SliderFloat("Bump", &bump, 0.0f, 1.0f);
-    ImGui::SliderFloat("Clip", &clip, 0.0f, 1.0f);
-}
 
 float TRXSnareDrum::sine(float x) {
     return std::sin(x);
 }
+
+// Parameter table; the row index is the id used by saved files and kit banks
+// (append only)
+const ParamEntry<TRXSnareDrum> TRXSnareDrum::kParams[] = {
+    {&TRXSnareDrum::pitch, {"Pitch", 60.0f, 400.0f, 180.0f, ParamCurve::Log}},
+    {&TRXSnareDrum::decay, {"Decay", 0.05f, 1.0f, 0.4f, ParamCurve::Log}},
+    {&TRXSnareDrum::snap, {"Snap", 0.0f, 1.0f, 0.6f}},
+    {&TRXSnareDrum::noise, {"Noise", 0.0f, 1.0f, 0.5f}},
+    {&TRXSnareDrum::tone, {"Tone Balance", 0.0f, 1.0f, 0.5f}},
+    {&TRXSnareDrum::tune, {"Tune Interval", 0.0f, 400.0f, 100.0f}},
+    {&TRXSnareDrum::bump, {"Bump", 0.0f, 1.0f, 0.1f}},
+    {&TRXSnareDrum::clip, {"Clip", 0.0f, 1.0f, 0.2f}}
+};
+const size_t TRXSnareDrum::kNumParams = sizeof(kParams) / sizeof(kParams[0]);
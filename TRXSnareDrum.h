@@ -1,32 +1,29 @@
 #pragma once
-#include "DrumModel.h"
+#include "ParamModel.h"
+#include "WhiteNoise.h"
 
-class TRXSnareDrum : public DrumModel {
+class TRXSnareDrum : public ParamModel<TRXSnareDrum> {
 public:
+    TRXSnareDrum() { ResetParameters(); }
     void Init() override;
     void Trigger() override;
     float Process() override;
-    void RenderControls() override;
-
-    void saveParameters(std::ostream& os) const override {
-        os << pitch << ' ' << decay << ' ' << snap << ' ' << noise
-           << ' ' << tone << ' ' << tune << ' ' << bump << ' ' << clip << '\n';
-    }
-
-    void loadParameters(std::istream& is) override {
-        is >> pitch >> decay >> snap >> noise >> tone >> tune >> bump >> clip;
-    }
+    void UpdateCoefficients() override;
 
 private:
-    // Parameters
-    float pitch = 180.0f;      // Base pitch (Hz)
-    float decay = 0.4f;        // Amplitude decay
-    float snap = 0.6f;         // Extra noisy attack
-    float noise = 0.5f;        // Noise level
-    float tone = 0.5f;         // Balance between oscillators
-    float tune = 100.0f;       // Frequency interval between osc1 and osc2
-    float bump = 0.1f;         // Small pitch rise at start
-    float clip = 0.2f;         // Clipping intensity
+    friend class ParamModel<TRXSnareDrum>;
+    static const ParamEntry<TRXSnareDrum> kParams[];
+    static const size_t kNumParams;
+
+    // Parameters (defaults in kParams)
+    float pitch;      // Base pitch (Hz)
+    float decay;      // Amplitude decay
+    float snap;       // Extra noisy attack
+    float noise;      // Noise level
+    float tone;       // Balance between oscillators
+    float tune;       // Frequency interval between osc1 and osc2
+    float bump;       // Small pitch rise at start
+    float clip;       // Clipping intensity
 
     // Envelope
     float t = 0.0f;
@@ -40,5 +37,12 @@ private:
     // Filter state for noise
     float hp_x = 0.0f, hp_y = 0.0f;
 
+    // Per-sample coefficients, from UpdateCoefficients()
+    float ampDecay = 0.0f;
+    float snapDecay = 0.0f;
+    float hp_a = 0.0f;
+
+    WhiteNoise noiseSource;
+
     float sine(float x);
 };
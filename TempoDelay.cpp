@@ -0,0 +1,83 @@
+#include "TempoDelay.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Length of each division in quarter notes
+constexpr float kQuarters[TempoDelay::NUM_DIVISIONS] = {0.25f, 1.0f / 3.0f, 0.5f, 0.75f, 1.0f, 1.5f};
+constexpr const char* kNames[TempoDelay::NUM_DIVISIONS] = {"1/16", "1/8 triplet", "1/8", "1/8 dotted", "1/4", "1/4 dotted"};
+constexpr float kGlideSeconds = 0.05f;
+// Keeps the fading repeats out of the denormal range
+constexpr float kAntiDenormal = 1e-20f;
+}
+
+const char* TempoDelay::DivisionName(int division) {
+    return division >= 0 && division < NUM_DIVISIONS ? kNames[division] : "";
+}
+
+void TempoDelay::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    size_ = 1;
+    while (size_ < (size_t)(kMaxSeconds * sampleRate) + 2) size_ <<= 1;
+    left_.assign(size_, 0.0f);
+    right_.assign(size_, 0.0f);
+    Clear();
+}
+
+void TempoDelay::SetDivision(int division) {
+    division_.store(std::max(0, std::min(division, NUM_DIVISIONS - 1)), std::memory_order_relaxed);
+}
+
+void TempoDelay::SetFeedback(float feedback) {
+    feedback_.store(std::max(0.0f, std::min(feedback, 0.95f)), std::memory_order_relaxed);
+}
+
+void TempoDelay::SetTone(float tone) {
+    tone_.store(std::max(0.0f, std::min(tone, 1.0f)), std::memory_order_relaxed);
+}
+
+void TempoDelay::Clear() {
+    std::fill(left_.begin(), left_.end(), 0.0f);
+    std::fill(right_.begin(), right_.end(), 0.0f);
+    write_ = 0;
+    delay_ = 0.0f;
+    lowpass_[0] = lowpass_[1] = 0.0f;
+}
+
+void TempoDelay::Process(const float* send, float* left, float* right, size_t frames, float bpm) {
+    if (left_.empty()) return;
+    float seconds = 60.0f / std::max(bpm, 1.0f) * kQuarters[division_.load(std::memory_order_relaxed)];
+    float target = std::min(seconds * sampleRate_, (float)(size_ - 2));
+    if (delay_ <= 0.0f) delay_ = target;
+    float glide = 1.0f - std::exp(-1.0f / (kGlideSeconds * sampleRate_));
+    float feedback = feedback_.load(std::memory_order_relaxed);
+    float cutoff = 1000.0f * std::pow(16.0f, tone_.load(std::memory_order_relaxed)); // 1-16 kHz
+    float toneCoef = 1.0f - std::exp(-2.0f * (float)M_PI * std::min(cutoff, 0.45f * sampleRate_) / sampleRate_);
+    bool pingPong = pingPong_.load(std::memory_order_relaxed);
+    const size_t mask = size_ - 1;
+
+    for (size_t i = 0; i < frames; ++i) {
+        delay_ += (target - delay_) * glide;
+        // Linear interpolation between the two samples around the read position
+        size_t whole = (size_t)delay_;
+        float fraction = delay_ - (float)whole;
+        size_t a = (write_ - whole) & mask, b = (write_ - whole - 1) & mask;
+        float l = left_[a] + (left_[b] - left_[a]) * fraction;
+        float r = right_[a] + (right_[b] - right_[a]) * fraction;
+
+        lowpass_[0] += (l - lowpass_[0]) * toneCoef;
+        lowpass_[1] += (r - lowpass_[1]) * toneCoef;
+        float in = send[i] + kAntiDenormal;
+        if (pingPong) {
+            left_[write_] = in + feedback * lowpass_[1];
+            right_[write_] = feedback * lowpass_[0];
+        } else {
+            left_[write_] = in + feedback * lowpass_[0];
+            right_[write_] = in + feedback * lowpass_[1];
+        }
+        write_ = (write_ + 1) & mask;
+        left[i] += l;
+        right[i] += r;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Tempo-synced stereo delay for the send bus. The delay time is a note
+// division of the sequencer tempo; tempo changes glide the read position so
+// they do not click. In ping-pong mode the echoes alternate between left
+// and right. The feedback path has a one-pole low-pass (tone) so repeats
+// darken as they decay.
+//
+// The GUI sets everything through atomics; Process runs on the audio thread
+// and never allocates.
+class TempoDelay {
+public:
+    enum Division { SIXTEENTH, EIGHTH_TRIPLET, EIGHTH, DOTTED_EIGHTH, QUARTER, DOTTED_QUARTER, NUM_DIVISIONS };
+    static const char* DivisionName(int division);
+    static constexpr float kMaxSeconds = 4.5f; // a dotted quarter at 20 BPM
+
+    // Allocates the delay line; call before the stream starts
+    void Init(float sampleRate);
+
+    // GUI thread
+    void SetDivision(int division);
+    int division() const { return division_.load(std::memory_order_relaxed); }
+    void SetFeedback(float feedback); // 0-0.95
+    float feedback() const { return feedback_.load(std::memory_order_relaxed); }
+    void SetTone(float tone); // 0 (dark) to 1 (open)
+    float tone() const { return tone_.load(std::memory_order_relaxed); }
+    void SetPingPong(bool on) { pingPong_.store(on, std::memory_order_relaxed); }
+    bool pingPong() const { return pingPong_.load(std::memory_order_relaxed); }
+
+    // Adds the echoes of the send to left and right
+    void Process(const float* send, float* left, float* right, size_t frames, float bpm);
+    void Clear();
+
+private:
+    float sampleRate_ = 48000.0f;
+    size_t size_ = 0; // power of two
+    std::vector<float> left_, right_;
+    size_t write_ = 0;
+    float delay_ = 0.0f; // current delay in samples, gliding to the target
+    float lowpass_[2] = {};
+
+    std::atomic<int> division_{EIGHTH};
+    std::atomic<float> feedback_{0.4f};
+    std::atomic<float> tone_{0.6f};
+    std::atomic<bool> pingPong_{true};
+};
@@ -0,0 +1,136 @@
+#include "TrackInsert.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mi/dsp.h"
+#include "mi/parameter_interpolator.h"
+#include "mi/resources.h"
+
+namespace {
+const int16_t* const kShapes[] = {plaits::lut_ws_inverse_tan, plaits::lut_ws_inverse_sin, plaits::lut_ws_linear,
+                                  plaits::lut_ws_bump, plaits::lut_ws_double_bump};
+constexpr int kNumShapes = 5;
+const float* const kFoldCurves[] = {plaits::lut_fold, plaits::lut_fold_2};
+// The fold curves rise with a slope of about 20 at zero, so this gain
+// leaves quiet input roughly at its level; full fold drives them 20x harder
+constexpr float kMinFoldGain = 0.05f;
+constexpr float kMaxDriveGain = 8.0f;
+
+inline float Clamp(float x, float lo, float hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+// 256 segments over -1..1, as plaits' waveshaping oscillator reads them
+inline float Shape(const int16_t* table, float x) {
+    float index = 128.0f * x + 128.0f;
+    MAKE_INTEGRAL_FRACTIONAL(index)
+    if (index_integral > 255) index_integral = 255, index_fractional = 1.0f;
+    float a = table[index_integral] / 32768.0f;
+    float b = table[index_integral + 1] / 32768.0f;
+    return a + (b - a) * index_fractional;
+}
+}
+
+const char* TrackInsert::FilterModeName(int mode) {
+    static const char* const names[NUM_FILTER_MODES] = {"Off", "Low Pass", "Band Pass", "High Pass"};
+    return mode >= 0 && mode < NUM_FILTER_MODES ? names[mode] : "";
+}
+
+void TrackInsert::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    state1_ = state2_ = 0.0f;
+    appliedMode_ = FILTER_OFF;
+}
+
+void TrackInsert::Set(const Settings& s) {
+    filterMode_.store(std::max(0, std::min(s.filterMode, NUM_FILTER_MODES - 1)), std::memory_order_relaxed);
+    cutoff_.store(Clamp(s.cutoff, 0.0f, 1.0f), std::memory_order_relaxed);
+    resonance_.store(Clamp(s.resonance, 0.0f, 1.0f), std::memory_order_relaxed);
+    drive_.store(Clamp(s.drive, 0.0f, 1.0f), std::memory_order_relaxed);
+    shapeSetting_.store(Clamp(s.shape, 0.0f, 1.0f), std::memory_order_relaxed);
+    fold_.store(Clamp(s.fold, 0.0f, 1.0f), std::memory_order_relaxed);
+    foldCurve_.store(std::max(0, std::min(s.foldCurve, NUM_FOLD_CURVES - 1)), std::memory_order_relaxed);
+}
+
+TrackInsert::Settings TrackInsert::settings() const {
+    Settings s;
+    s.filterMode = filterMode_.load(std::memory_order_relaxed);
+    s.cutoff = cutoff_.load(std::memory_order_relaxed);
+    s.resonance = resonance_.load(std::memory_order_relaxed);
+    s.drive = drive_.load(std::memory_order_relaxed);
+    s.shape = shapeSetting_.load(std::memory_order_relaxed);
+    s.fold = fold_.load(std::memory_order_relaxed);
+    s.foldCurve = foldCurve_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void TrackInsert::Process(float* buffer, size_t frames) {
+    if (frames == 0) return;
+    Settings s = settings();
+
+    // Chunk-rate targets: the filter in the zero-delay-feedback form of
+    // stmlib's Svf, g = tan(pi f / fs), r = 1 / Q, h = 1 / (1 + r g + g^2)
+    float frequency = std::min(20.0f * std::pow(1000.0f, s.cutoff), 0.45f * sampleRate_);
+    float g = std::tan((float)M_PI * frequency / sampleRate_);
+    float r = 2.0f / std::pow(40.0f, s.resonance);
+    float h = 1.0f / (1.0f + r * g + g * g);
+    float driveGain = 1.0f + (kMaxDriveGain - 1.0f) * s.drive;
+    float driveMix = std::min(1.0f, 4.0f * s.drive);
+    float shape = s.shape * (kNumShapes - 1.001f);
+    float foldGain = kMinFoldGain * std::pow(1.0f / kMinFoldGain, s.fold);
+    float foldMix = std::min(1.0f, 4.0f * s.fold);
+
+    bool filtering = s.filterMode != FILTER_OFF;
+    if (filtering && appliedMode_ == FILTER_OFF) {
+        // Starts from rest at the current coefficients
+        state1_ = state2_ = 0.0f;
+        g_ = g, r_ = r, h_ = h;
+    }
+    appliedMode_ = s.filterMode;
+    // Output mix of the low, band and high pass outputs; the band pass is
+    // normalised by r so resonance narrows it without boosting the peak
+    float lowGain = s.filterMode == FILTER_LOW_PASS, bandGain = s.filterMode == FILTER_BAND_PASS;
+    float highGain = s.filterMode == FILTER_HIGH_PASS;
+
+    // The interpolators write back where they ended; the targets are then
+    // set exactly, so a stage ramped to zero is skipped again
+    if (filtering) {
+        stmlib::ParameterInterpolator gs(&g_, g, frames), rs(&r_, r, frames), hs(&h_, h, frames);
+        for (size_t i = 0; i < frames; ++i) {
+            float gi = gs.Next(), ri = rs.Next(), hi = hs.Next();
+            float hp = (buffer[i] - (ri + gi) * state1_ - state2_) * hi;
+            float bp = gi * hp + state1_;
+            state1_ = gi * hp + bp;
+            float lp = gi * bp + state2_;
+            state2_ = gi * bp + lp;
+            buffer[i] = lowGain * lp + bandGain * ri * bp + highGain * hp;
+        }
+    }
+    g_ = g, r_ = r, h_ = h;
+
+    if (driveMix > 0.0f || driveMix_ > 0.0f) {
+        stmlib::ParameterInterpolator gains(&driveGain_, driveGain, frames), mixes(&driveMix_, driveMix, frames);
+        stmlib::ParameterInterpolator shapes(&shape_, shape, frames);
+        for (size_t i = 0; i < frames; ++i) {
+            float x = buffer[i];
+            float in = Clamp(x * gains.Next(), -1.0f, 1.0f);
+            float position = shapes.Next();
+            MAKE_INTEGRAL_FRACTIONAL(position)
+            float a = Shape(kShapes[position_integral], in);
+            float b = Shape(kShapes[position_integral + 1], in);
+            buffer[i] = x + (a + (b - a) * position_fractional - x) * mixes.Next();
+        }
+    }
+    driveGain_ = driveGain, driveMix_ = driveMix, shape_ = shape;
+
+    if (foldMix > 0.0f || foldMix_ > 0.0f) {
+        const float* curve = kFoldCurves[s.foldCurve];
+        stmlib::ParameterInterpolator gains(&foldGain_, foldGain, frames), mixes(&foldMix_, foldMix, frames);
+        for (size_t i = 0; i < frames; ++i) {
+            float x = buffer[i];
+            float in = Clamp(x * gains.Next(), -1.0f, 1.0f);
+            float folded = stmlib::Interpolate(curve, 0.5f + 0.5f * in, 512.0f);
+            buffer[i] = x + (folded - x) * mixes.Next();
+        }
+    }
+    foldGain_ = foldGain, foldMix_ = foldMix;
+}
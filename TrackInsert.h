@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Insert chain of one track: a state-variable filter, then a waveshaper
+// crossfading between plaits' five lut_ws_* curves, then a wavefolder on
+// lut_fold / lut_fold_2. The GUI writes the settings through atomics. Once
+// per render chunk they become filter coefficients and stage gains, which
+// are ramped linearly across the chunk; per sample the chain is a few
+// multiply-adds and table reads, cheap enough for every track. Stages that
+// are off cost nothing.
+//
+// Process runs on whichever render thread has the track.
+class TrackInsert {
+public:
+    enum FilterMode { FILTER_OFF, FILTER_LOW_PASS, FILTER_BAND_PASS, FILTER_HIGH_PASS, NUM_FILTER_MODES };
+    enum FoldCurve { FOLD_SINE, FOLD_COSINE, NUM_FOLD_CURVES }; // lut_fold, lut_fold_2
+    static const char* FilterModeName(int mode);
+
+    struct Settings {
+        int filterMode = FILTER_OFF;
+        float cutoff = 0.7f;    // 0-1: 20 Hz to 20 kHz, exponential
+        float resonance = 0.0f; // 0-1: Q from 0.5 to 20
+        float drive = 0.0f;     // 0-1, 0 bypasses the shaper
+        float shape = 0.0f;     // 0-1 across inverse tan, inverse sin, linear, bump, double bump
+        float fold = 0.0f;      // 0-1, 0 bypasses the folder
+        int foldCurve = FOLD_SINE;
+    };
+
+    void Init(float sampleRate);
+
+    // GUI thread
+    void Set(const Settings& settings);
+    Settings settings() const;
+
+    // In place, over one render chunk
+    void Process(float* buffer, size_t frames);
+
+private:
+    float sampleRate_ = 48000.0f;
+
+    // Audio side: the filter state and the coefficients the last chunk
+    // ended on
+    float state1_ = 0.0f, state2_ = 0.0f;
+    int appliedMode_ = FILTER_OFF;
+    float g_ = 0.0f, r_ = 2.0f, h_ = 1.0f;
+    float driveGain_ = 1.0f, driveMix_ = 0.0f, shape_ = 0.0f;
+    float foldGain_ = 0.0f, foldMix_ = 0.0f;
+
+    std::atomic<int> filterMode_{FILTER_OFF};
+    std::atomic<float> cutoff_{0.7f};
+    std::atomic<float> resonance_{0.0f};
+    std::atomic<float> drive_{0.0f};
+    std::atomic<float> shapeSetting_{0.0f};
+    std::atomic<float> fold_{0.0f};
+    std::atomic<int> foldCurve_{FOLD_SINE};
+};
@@ -0,0 +1,193 @@
+#include "WavRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr size_t kHeaderBytes = 80;          // RIFF + JUNK/ds64 + fmt + data headers
+constexpr uint64_t kRiffLimit = 0xFFFFFFFFull;
+constexpr int kHeaderRefreshMs = 2000;       // keep sizes current in case of a crash
+
+void Put16(char* p, uint16_t v) { p[0] = (char)v; p[1] = (char)(v >> 8); }
+void Put32(char* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = (char)(v >> (8 * i)); }
+void Put64(char* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = (char)(v >> (8 * i)); }
+
+}
+
+WavRecorder::~WavRecorder() {
+    Stop();
+}
+
+bool WavRecorder::Start(const std::string& basename, Format format, const std::vector<std::string>& trackNames,
+                        float sampleRate, std::string* error) {
+    Stop();
+    format_ = format;
+    sampleRate_ = sampleRate;
+    channels_ = 2 + trackNames.size();
+    ring_.reset(new float[kRingFrames * channels_]);
+    writePos_ = readPos_ = 0;
+    framesRecorded_ = overruns_ = droppedFrames_ = 0;
+
+    auto open = [&](const std::string& path, size_t first, size_t count) {
+        File file;
+        file.fp = std::fopen(path.c_str(), "wb");
+        file.firstChannel = first;
+        file.channels = count;
+        if (!file.fp) {
+            if (error) *error = "cannot create " + path;
+            return false;
+        }
+        files_.push_back(file);
+        WriteHeader(files_.back(), false);
+        return true;
+    };
+    bool ok = open(basename + ".wav", 0, 2);
+    for (size_t t = 0; ok && t < trackNames.size(); ++t) {
+        char index[24];
+        std::snprintf(index, sizeof(index), "_%02zu_", t + 1);
+        ok = open(basename + index + trackNames[t] + ".wav", 2 + t, 1);
+    }
+    if (!ok) {
+        CloseFiles();
+        return false;
+    }
+    quit_ = false;
+    writer_ = std::thread(&WavRecorder::Run, this);
+    active_.store(true, std::memory_order_release);
+    return true;
+}
+
+void WavRecorder::Stop() {
+    if (!writer_.joinable()) return;
+    active_.store(false, std::memory_order_seq_cst);
+    // Wait for a block that may still be pushing, then let the writer drain
+    while (busy_.load(std::memory_order_seq_cst)) std::this_thread::yield();
+    quit_ = true;
+    writer_.join();
+    CloseFiles();
+}
+
+size_t WavRecorder::BeginBlock() {
+    busy_.store(true, std::memory_order_seq_cst);
+    if (!active_.load(std::memory_order_seq_cst)) {
+        busy_.store(false, std::memory_order_release);
+        return 0;
+    }
+    return channels_;
+}
+
+void WavRecorder::Push(const float* frames, size_t count) {
+    uint64_t w = writePos_.load(std::memory_order_relaxed);
+    uint64_t r = readPos_.load(std::memory_order_acquire);
+    if (kRingFrames - (w - r) < count) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames_.fetch_add(count, std::memory_order_relaxed);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        size_t slot = (size_t)((w + i) & (kRingFrames - 1));
+        std::memcpy(&ring_[slot * channels_], frames + i * channels_, channels_ * sizeof(float));
+    }
+    writePos_.store(w + count, std::memory_order_release);
+}
+
+void WavRecorder::Run() {
+    auto lastHeader = std::chrono::steady_clock::now();
+    for (;;) {
+        bool quitting = quit_.load();
+        Drain();
+        if (quitting) break; // quit_ is set after the last push
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastHeader > std::chrono::milliseconds(kHeaderRefreshMs)) {
+            for (File& file : files_) WriteHeader(file, false);
+            lastHeader = now;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void WavRecorder::Drain() {
+    uint64_t r = readPos_.load(std::memory_order_relaxed);
+    uint64_t w = writePos_.load(std::memory_order_acquire);
+    size_t bytesPerSample = format_ == Format::Float32 ? 4 : 3;
+    while (r < w) {
+        size_t count = (size_t)std::min<uint64_t>(w - r, 4096);
+        for (File& file : files_) {
+            scratch_.resize(count * file.channels * bytesPerSample);
+            char* out = scratch_.data();
+            for (size_t i = 0; i < count; ++i) {
+                const float* frame = &ring_[((r + i) & (kRingFrames - 1)) * channels_];
+                for (size_t c = 0; c < file.channels; ++c) {
+                    float x = frame[file.firstChannel + c];
+                    if (format_ == Format::Float32) {
+                        std::memcpy(out, &x, 4);
+                        out += 4;
+                    } else {
+                        x = std::max(-1.0f, std::min(1.0f, x));
+                        int32_t v = (int32_t)std::lrintf(x * 8388607.0f);
+                        out[0] = (char)v;
+                        out[1] = (char)(v >> 8);
+                        out[2] = (char)(v >> 16);
+                        out += 3;
+                    }
+                }
+            }
+            file.dataBytes += std::fwrite(scratch_.data(), 1, scratch_.size(), file.fp);
+        }
+        r += count;
+        readPos_.store(r, std::memory_order_release);
+        framesRecorded_.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+// Canonical 80-byte header: RIFF, a JUNK chunk reserved for ds64, fmt, data.
+// Sizes that do not fit 32 bits turn the file into RF64 when it is closed.
+void WavRecorder::WriteHeader(File& file, bool final) {
+    uint16_t bytesPerSample = format_ == Format::Float32 ? 4 : 3;
+    uint16_t blockAlign = (uint16_t)(file.channels * bytesPerSample);
+    uint64_t riffSize = kHeaderBytes - 8 + file.dataBytes + (file.dataBytes & 1); // pad byte
+    bool rf64 = final && riffSize > kRiffLimit;
+    if (!final && riffSize > kRiffLimit) return; // leave the last valid sizes
+
+    char h[kHeaderBytes] = {};
+    std::memcpy(h, rf64 ? "RF64" : "RIFF", 4);
+    Put32(h + 4, rf64 ? 0xFFFFFFFFu : (uint32_t)riffSize);
+    std::memcpy(h + 8, "WAVE", 4);
+    std::memcpy(h + 12, rf64 ? "ds64" : "JUNK", 4);
+    Put32(h + 16, 28);
+    if (rf64) {
+        Put64(h + 20, riffSize);
+        Put64(h + 28, file.dataBytes);
+        Put64(h + 36, file.dataBytes / blockAlign);
+        Put32(h + 44, 0); // no table
+    }
+    std::memcpy(h + 48, "fmt ", 4);
+    Put32(h + 52, 16);
+    Put16(h + 56, format_ == Format::Float32 ? kFormatFloat : kFormatPcm);
+    Put16(h + 58, (uint16_t)file.channels);
+    Put32(h + 60, (uint32_t)sampleRate_);
+    Put32(h + 64, (uint32_t)sampleRate_ * blockAlign);
+    Put16(h + 68, blockAlign);
+    Put16(h + 70, (uint16_t)(bytesPerSample * 8));
+    std::memcpy(h + 72, "data", 4);
+    Put32(h + 76, rf64 ? 0xFFFFFFFFu : (uint32_t)file.dataBytes);
+
+    std::fseek(file.fp, 0, SEEK_SET);
+    std::fwrite(h, 1, sizeof(h), file.fp);
+    std::fseek(file.fp, 0, SEEK_END);
+    std::fflush(file.fp);
+}
+
+void WavRecorder::CloseFiles() {
+    for (File& file : files_) {
+        if (file.dataBytes & 1) std::fputc(0, file.fp); // chunks are word aligned
+        WriteHeader(file, true);
+        std::fclose(file.fp);
+    }
+    files_.clear();
+}
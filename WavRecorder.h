@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records the master bus and optionally every track to WAV files. The audio
+// thread copies interleaved frames into a preallocated single-producer ring
+// and never blocks; a writer thread converts and writes them. If the writer
+// falls behind, whole chunks are dropped and counted as overruns.
+//
+// Frame layout: master L, master R, then one sample per track when
+// per-track recording is on. Files switch to RF64 on close when they grow
+// past the 4 GiB RIFF limit, so multi-hour takes stay readable.
+class WavRecorder {
+public:
+    enum class Format { Float32, Int24 };
+
+    ~WavRecorder();
+
+    // GUI thread. Opens <basename>.wav (and <basename>_NN_<track>.wav)
+    bool Start(const std::string& basename, Format format, const std::vector<std::string>& trackNames,
+               float sampleRate, std::string* error = nullptr);
+    void Stop();
+    bool isRecording() const { return active_.load(std::memory_order_acquire); }
+
+    // Audio thread, once per block: BeginBlock returns the frame width to
+    // push (0 when not recording), EndBlock must follow.
+    size_t BeginBlock();
+    void Push(const float* frames, size_t count);
+    void EndBlock() { busy_.store(false, std::memory_order_release); }
+
+    uint64_t framesRecorded() const { return framesRecorded_.load(std::memory_order_relaxed); }
+    uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+    uint64_t droppedFrames() const { return droppedFrames_.load(std::memory_order_relaxed); }
+
+private:
+    struct File {
+        FILE* fp = nullptr;
+        size_t firstChannel = 0, channels = 0;
+        uint64_t dataBytes = 0;
+    };
+
+    void Run();
+    void Drain();
+    void WriteHeader(File& file, bool final);
+    void CloseFiles();
+
+    static constexpr size_t kRingFrames = size_t(1) << 18; // ~5 s at 48 kHz
+
+    Format format_ = Format::Float32;
+    float sampleRate_ = 48000.0f;
+    size_t channels_ = 0;
+    std::unique_ptr<float[]> ring_;
+    alignas(64) std::atomic<uint64_t> writePos_{0}; // in frames
+    alignas(64) std::atomic<uint64_t> readPos_{0};
+
+    std::atomic<bool> active_{false};
+    std::atomic<bool> busy_{false};
+    std::atomic<bool> quit_{false};
+    std::atomic<uint64_t> framesRecorded_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+
+    std::vector<File> files_;
+    std::vector<char> scratch_;
+    std::thread writer_;
+};
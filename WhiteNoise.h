@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-instance white noise: the LCG of stmlib::Random, but with its own
+// state so models rendering on different threads never share a generator
+// (rand() takes a process-wide lock on every call).
+class WhiteNoise {
+public:
+    explicit WhiteNoise(uint32_t seed = 0) : state_(seed) {}
+    void Seed(uint32_t seed) { state_ = seed; }
+
+    // Uniform in [-1, 1)
+    inline float Next() {
+        state_ = state_ * 1664525u + 1013904223u;
+        return (float)(int32_t)state_ / 2147483648.0f;
+    }
+
+private:
+    uint32_t state_ = 0;
+};
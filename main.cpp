@@ -9,9 +9,12 @@
 #include <RtAudio.h>
 #include <fstream>
 #include <filesystem>
-#include <deque>
 #include <complex>
 #include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
 
 #include <GLFW/glfw3.h>
 #include "imgui.h"
@@ -19,19 +22,30 @@
 #include "imgui_impl_opengl3.h"
 
 #include "DrumModel.h"
-#include "FmKickModel.h"
-#include "FmSnareModel.h"
-#include "FmTomModel.h"
-#include "FmClapModel.h"
-#include "FmRimshotModel.h"
-#include "FmCowbellModel.h"
-#include "FmCymbalModel.h"
-#include "TRXBassDrum.h"
-#include "TRXSnareDrum.h"
-#include "TRXClaves.h"
-#include "TRXHiHat.h"
+#include "DrumKit.h"
 
 #include "CustomControls.h"
+#include "LevelMeter.h"
+#include "LookaheadLimiter.h"
+#include "ChannelDelay.h"
+#include "PeakPyramid.h"
+#include "SpscQueue.h"
+#include "SampleTap.h"
+#include "PresetBank.h"
+#include "ParamSaver.h"
+#include "FileWatcher.h"
+#include "WavRecorder.h"
+#include "RenderCache.h"
+#include "StepSequencer.h"
+#include "ParamSmoother.h"
+#include "ModMatrix.h"
+#include "RenderPool.h"
+#include "Realtime.h"
+#include "AllocationGuard.h"
+#include "AudioOutput.h"
+#include "FdnReverb.h"
+#include "TempoDelay.h"
+#include "TrackInsert.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -40,17 +54,137 @@
 constexpr float PI = 3.14159265f;
 constexpr float TWO_PI = 2.0f * PI;
 constexpr float SAMPLE_RATE = 48000.0f;
-constexpr size_t BUFFER_SIZE = 256;
 constexpr size_t WAVEFORM_BUFFER_SIZE = 48000;
 constexpr size_t FFT_SIZE = 256;
 constexpr size_t WATERFALL_HISTORY = 256;
+constexpr size_t MAX_TRACKS = 16;
 
 std::mutex param_mutex;
-std::atomic<bool> trigger_requested(false);
 std::atomic<size_t> selected_model_index = 0;
 
+// Trigger requests from the GUI thread, timestamped when the input arrived
+struct TriggerEvent {
+    uint32_t track;
+    double time; // steady clock, seconds
+};
+SpscQueue<TriggerEvent, 256> triggerQueue;
+constexpr size_t MAX_BLOCK_TRIGGERS = 64;
+
+// Pattern sequencer, run by the audio callback
+StepSequencer sequencer(SAMPLE_RATE);
+static_assert(MAX_TRACKS <= StepSequencer::kTracks, "StepSequencer has too few tracks");
+
+// Drum pad keys: bottom row plays tracks 1-8, home row tracks 9-16.
+// Space always plays the track selected in the controls window.
+const int kPadKeys[MAX_TRACKS] = {
+    GLFW_KEY_Z, GLFW_KEY_X, GLFW_KEY_C, GLFW_KEY_V, GLFW_KEY_B, GLFW_KEY_N, GLFW_KEY_M, GLFW_KEY_COMMA,
+    GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_F, GLFW_KEY_G, GLFW_KEY_H, GLFW_KEY_J, GLFW_KEY_K
+};
+
+// The GUI edits its own copy of the newest kit. The audio thread renders
+// audioKit, which it takes over from kitExchange at a block boundary; the
+// outgoing kit's voices ring out alongside the new kit until each has been
+// silent for a while, and the kit is then handed back to be freed. Tails
+// still sounding after KIT_RING_SECONDS, or when yet another kit is
+// waiting, fade out over gKitCrossfadeMs.
 std::vector<std::shared_ptr<DrumModel>> models;
 std::vector<std::string> model_names;
+KitExchange kitExchange;
+DrumKit* audioKit = nullptr;  // owned by the audio thread while the stream runs
+DrumKit* fadingKit = nullptr; // ditto
+std::atomic<float> gKitCrossfadeMs{10.0f};
+constexpr float KIT_RING_SECONDS = 5.0f;
+constexpr float KIT_SILENCE_LEVEL = 1e-4f;      // -80 dBFS
+constexpr unsigned int KIT_SILENCE_FRAMES = 2400; // 50 ms below it ends a tail
+unsigned int kitQuietFrames[MAX_TRACKS];        // per track, of the outgoing kit
+
+// Parameter edits reach the audio kit as single changes, tagged with the
+// generation of the kit they were made on. The GUI compares its models with
+// the values it last sent once per frame.
+struct ParamChange {
+    uint32_t generation;
+    uint16_t track;
+    uint16_t param;
+    float value;
+};
+SpscQueue<ParamChange, 1024> paramChanges;
+ParamSnapshot sentParams;    // GUI thread
+uint32_t guiGeneration = 0;  // generation of the kit `models` belongs to
+uint32_t lastGeneration = 0; // guarded by reloadMutex
+
+// Edits to continuous parameters ramp across the block they arrive in; one
+// smoother per track, as tracks render on different threads
+ParamSmoother paramSmoothers[MAX_TRACKS];
+
+// Per-track LFOs and the modulation matrix, evaluated at control rate
+ModMatrix modMatrix(SAMPLE_RATE);
+static_assert(MAX_TRACKS <= ModMatrix::kTracks, "ModMatrix has too few tracks");
+
+// Tracks render in parallel on the callback thread and the pool's helpers,
+// RENDER_CHUNK frames at a time, into their own buffers; the callback then
+// mixes those
+RenderPool renderPool;
+constexpr unsigned int RENDER_CHUNK = 256;
+static_assert(RENDER_CHUNK <= ModMatrix::kMaxBlockFrames, "render chunks are too long for ModMatrix");
+float trackBuffers[MAX_TRACKS][RENDER_CHUNK];
+// Below this many track frames per chunk the tracks render inline: with
+// small buffers and few voices, handing them out costs more than it saves
+constexpr size_t PARALLEL_MIN_WORK = 512;
+
+// Values the parameter locks of the last sequenced hit replaced, per track of
+// audioKit; they are put back on the track's next trigger (audio thread)
+StepLocks lockedBase[MAX_TRACKS];
+
+// Binary kit bank, memory-mapped; switching kits reads records in place
+const char* bank_file = "drum_bank.fmdb";
+PresetBank::Bank kitBank;
+int kitBankIndex = 0;
+std::string kitBankStatus;
+
+// Parameter files are written on a background thread from a snapshot, so
+// saving never holds param_mutex for longer than a copy of the values
+const char* param_file = "drum_params.txt";
+const char* autosave_file = "drum_params.autosave.txt";
+bool gAutosave = true;
+constexpr double AUTOSAVE_INTERVAL = 10.0; // seconds between change checks
+ParamSnapshot lastAutosaved;
+
+// Optional hot reload of param_file. The watcher thread parses and validates
+// the file, builds a complete kit and stages it; the GUI adopts the new
+// models on its next frame. Staging from either thread happens under
+// reloadMutex so the GUI and the audio thread always end on the same kit.
+std::unique_ptr<FileWatcher> paramWatcher;
+bool gWatchParamFile = false;
+std::vector<size_t> trackParamCounts; // fixed after startup
+std::mutex reloadMutex;
+std::vector<std::shared_ptr<DrumModel>> reloadedModels; // guarded by reloadMutex
+uint32_t reloadedGeneration = 0;                        // ditto
+std::string reloadStatus;                               // ditto
+std::string paramFileText; // last text reloaded from or saved to param_file; ditto
+
+// Declared after the reload state: its destructor may still run the write hook
+ParamSaver paramSaver;
+
+// Recorder: the callback hands it frames in chunks of RECORD_CHUNK
+WavRecorder recorder;
+int gRecordFormat = 0; // WavRecorder::Format
+bool gRecordTracks = false;
+std::string recorderStatus;
+constexpr size_t RECORD_CHUNK = 256;
+float recordChunk[RECORD_CHUNK * (2 + MAX_TRACKS)];
+
+// Pre-rendered one-shots, played instead of the model when a track is
+// triggered with unchanged parameters. The GUI asks for a new render
+// whenever a track's parameters change.
+RenderCache renderCache(SAMPLE_RATE);
+bool gRenderCache = false;
+int gRenderCacheBudgetMb = 64;
+uint64_t renderCacheKeys[MAX_TRACKS] = {}; // last requested per track
+static_assert(MAX_TRACKS <= RenderCache::kMaxTracks, "RenderCache has too few tracks");
+
+// Level meters, updated in the audio thread (one per model track plus master)
+LevelMeter trackMeters[MAX_TRACKS];
+LevelMeter masterMeter;
 
 GLuint gBackgroundTex = 0;
 int gBackgroundW = 0, gBackgroundH = 0;
@@ -59,13 +193,17 @@ int gBackgroundW = 0, gBackgroundH = 0;
 GLuint gFftTex = 0;
 GLint bgFftTexLoc = -1;
 
-std::deque<float> waveformBuffer;
-std::mutex waveformMutex;
+// Captured waveform as a min/max pyramid; the display only reads O(pixels)
+// from it. GUI thread only: the callback sends its samples through
+// waveformChunks below.
+PeakPyramid waveformPyramid;
 
-std::vector<std::vector<float>> waterfallHistory(WATERFALL_HISTORY, std::vector<float>(FFT_SIZE/2, 0.0f));
+// Newest FFT frame; rows are streamed into the waterfall ring texture
+std::vector<float> waterfallColumn(FFT_SIZE/2, 0.0f);
 size_t waterfallPos = 0;
-std::vector<float> fftInputBuffer;
-std::mutex fftMutex;
+// Newest output samples for the spectrum displays, written lock-free by the callback
+SampleTap<4096> fftTap;
+std::vector<float> fftFrame(FFT_SIZE); // GUI thread
 
 // GLSL animated background shader (simple color pulse based on loudness)
 const char* bgVertexShaderSrc = R"(
@@ -145,9 +283,94 @@ void main() {
 GLuint bgShader = 0, bgVao = 0, bgVbo = 0;
 GLint bgLoudnessLoc = -1, bgTimeLoc = -1, bgTexLoc = -1;
 
+// Spectrogram shader: the ring texture holds raw FFT magnitudes (one row per
+// frame, one texel per bin). Frequency warping, dB scaling and colormapping are
+// done per pixel here, so switching scales costs nothing on the CPU.
+const char* wfFragmentShaderSrc = R"(
+#version 150 core
+in vec2 uv;
+out vec4 fragColor;
+uniform sampler2D ringTex;
+uniform float newestRow;   // normalized row of the newest frame
+uniform float historyRows; // number of rows in the ring
+uniform float nyquist;     // Hz
+uniform int scaleMode;     // 0 = linear, 1 = log, 2 = mel
+uniform int ampMode;       // 0 = linear, 1 = dB
+uniform float dbRange;     // dB below full scale mapped to black
+uniform int colormap;      // 0 = grayscale, 1 = inferno
+
+float melFromHz(float f) { return 2595.0 * log(1.0 + f / 700.0) / log(10.0); }
+float hzFromMel(float m) { return 700.0 * (pow(10.0, m / 2595.0) - 1.0); }
+
+// Polynomial fit of matplotlib's inferno colormap
+vec3 inferno(float t) {
+    const vec3 c0 = vec3(0.0002189403691192265, 0.001651004631001012, -0.01948089843709184);
+    const vec3 c1 = vec3(0.1065134194856116, 0.5639564367884091, 3.932712388889277);
+    const vec3 c2 = vec3(11.60249308247187, -3.972853965665698, -15.9423941062914);
+    const vec3 c3 = vec3(-41.70399613139459, 17.43639888205313, 44.35414519872813);
+    const vec3 c4 = vec3(77.162935699427, -33.40235894210092, -81.80730925738993);
+    const vec3 c5 = vec3(-71.31942824499214, 32.62606426397723, 73.20951985803202);
+    const vec3 c6 = vec3(25.13112622477341, -12.24266895238567, -23.07032500287172);
+    return c0 + t * (c1 + t * (c2 + t * (c3 + t * (c4 + t * (c5 + t * c6)))));
+}
+
+void main() {
+    float nBins = float(textureSize(ringTex, 0).x);
+    // Frequency axis: uv.y in [0,1] -> fractional bin index
+    float bin;
+    if (scaleMode == 1) {
+        bin = pow(10.0, uv.y * log(nBins - 1.0) / log(10.0));
+    } else if (scaleMode == 2) {
+        float f = hzFromMel(uv.y * melFromHz(nyquist));
+        bin = f / nyquist * nBins;
+    } else {
+        bin = uv.y * (nBins - 1.0);
+    }
+    bin = clamp(bin, 0.0, nBins - 1.0);
+    // Time axis: newest frame on the left, ring wraps via GL_REPEAT
+    float row = newestRow - uv.x * (historyRows - 1.0) / historyRows;
+    float mag = texture(ringTex, vec2((bin + 0.5) / nBins, row)).r;
+    float v;
+    if (ampMode == 1) {
+        // A full-scale sine peaks at 0.5 with the 1/N normalization
+        float db = 20.0 * log(max(mag, 1e-9) / 0.5) / log(10.0);
+        v = clamp(1.0 + db / dbRange, 0.0, 1.0);
+    } else {
+        v = clamp(mag * 20.0, 0.0, 1.0);
+    }
+    vec3 color = (colormap == 1) ? inferno(v) : vec3(v);
+    fragColor = vec4(color, 1.0);
+}
+)";
+
+GLuint wfShader = 0, wfRingTex = 0, wfFbo = 0, wfFboTex = 0;
+int wfFboW = 0, wfFboH = 0;
+GLint wfRingTexLoc = -1, wfNewestRowLoc = -1, wfHistoryRowsLoc = -1, wfNyquistLoc = -1;
+GLint wfScaleModeLoc = -1, wfAmpModeLoc = -1, wfDbRangeLoc = -1, wfColormapLoc = -1;
+// Without the shader or its framebuffer the spectrogram is drawn on the CPU:
+// magnitudes kept here, colormapped into an RGB texture
+bool wfGpu = false;
+GLuint wfCpuTex = 0;
+std::vector<float> waterfallHistory;     // WATERFALL_HISTORY rows of FFT_SIZE/2 bins
+std::vector<unsigned char> waterfallImage; // FFT_SIZE/2 rows of WATERFALL_HISTORY texels
+
 // Add global variable for spectrogram scale
-enum class SpectrogramScale { Linear, Log };
+enum class SpectrogramScale { Linear, Log, Mel };
 SpectrogramScale gSpectrogramScale = SpectrogramScale::Log;
+enum class SpectrogramAmplitude { Linear, Decibel };
+SpectrogramAmplitude gSpectrogramAmplitude = SpectrogramAmplitude::Linear;
+enum class SpectrogramColormap { Grayscale, Inferno };
+SpectrogramColormap gSpectrogramColormap = SpectrogramColormap::Grayscale;
+float gSpectrogramDbRange = 80.0f;
+
+// Idle throttling: with nothing sounding and no recent input the main loop
+// waits on events instead of redrawing at vsync
+bool gIdleThrottling = true;
+double gLastInputTime = 0.0;
+constexpr double ACTIVE_FRAME_INTERVAL = 1.0 / 60.0;
+constexpr double IDLE_FRAME_INTERVAL = 0.25; // seconds between idle redraws
+constexpr double INPUT_SETTLE_TIME = 0.5;    // stay live this long after input
+constexpr float SILENCE_THRESHOLD = 1e-4f;   // -80 dBFS master peak
 
 // Add global variable for waveform anchoring
 bool gWaveformAnchorZero = false;
@@ -157,12 +380,81 @@ bool gWaveformContinuous = false;
 std::atomic<bool> gWaveformCaptureActive{false};
 std::atomic<size_t> gWaveformCapturedSamples{0};
 
-// Audio device selection globals
-std::vector<std::string> audioDeviceNames;
-std::vector<unsigned int> audioDeviceIds;
-int selectedAudioDeviceIdx = -1;
-RtAudio dac;
-bool audioNeedsRestart = false;
+// Stream settings from the command line; the Audio menu changes the running
+// stream's settings from then on
+AudioOutput::Settings audioSettings;
+
+// Per-track outputs for mixing on a console: 0 plays the track on the main
+// outputs 1/2, n > 0 on channels 2n+1/2n+2 instead. The stream is reopened
+// with as many channels as the routing needs; a pair the device does not
+// have falls back to the main outputs.
+std::atomic<int> trackOutputs[MAX_TRACKS];
+
+// Per-track mix set from the GUI: pan from -1 (left) to 1 (right) and the
+// levels sent to the reverb and delay buses. The effects run once per
+// render chunk on the summed sends, so their cost does not grow with the
+// number of sounding tracks.
+struct TrackMix {
+    std::atomic<float> pan{0.0f};
+    std::atomic<float> reverbSend{0.0f};
+    std::atomic<float> delaySend{0.0f};
+};
+TrackMix trackMix[MAX_TRACKS];
+FdnReverb reverb;
+TempoDelay delay;
+TrackInsert trackInserts[MAX_TRACKS]; // filter and shaper on each track, before the mix
+LookaheadLimiter limiter;             // on the main output pair only
+ChannelDelay routedDelay;             // the routed pairs, by the limiter's latency
+
+// Gains the audio thread mixes a track with; new settings ramp in over a
+// render chunk
+struct MixGains {
+    float left = 1.0f;
+    float right = 1.0f;
+    float reverb = 0.0f;
+    float delay = 0.0f;
+};
+MixGains mixGains[MAX_TRACKS];
+
+// Constant power, scaled so a centred track plays at full level on both
+// sides as it did on the mono mix
+MixGains TargetGains(const TrackMix& mix) {
+    MixGains g;
+    float angle = (mix.pan.load(std::memory_order_relaxed) + 1.0f) * 0.25f * (float)M_PI;
+    g.left = std::cos(angle) * (float)M_SQRT2;
+    g.right = std::sin(angle) * (float)M_SQRT2;
+    g.reverb = mix.reverbSend.load(std::memory_order_relaxed);
+    g.delay = mix.delaySend.load(std::memory_order_relaxed);
+    return g;
+}
+
+unsigned int OutputChannelsNeeded() {
+    int pairs = 1;
+    for (const std::atomic<int>& output : trackOutputs) pairs = std::max(pairs, output.load(std::memory_order_relaxed) + 1);
+    return 2 * pairs;
+}
+
+// Real-time setup requested on the command line
+struct EngineOptions {
+    int rtPriority = 0;           // SCHED_FIFO priority of the audio and render threads, 0: leave as is
+    int audioCpu = -1;            // CPU for the audio thread, -1: any
+    std::vector<int> renderCpus;  // CPUs for the render helpers, used in turn
+    size_t renderThreads = 0;     // including the audio thread, 0: one per core
+    bool lockMemory = false;
+};
+EngineOptions engineOptions;
+
+// Scheduling each thread ended up with, published by the thread itself once
+// it has set itself up; the GUI shows and logs it
+struct ThreadReport {
+    std::atomic<bool> ready{false};
+    int error = 0; // of the setup, errno
+    ThreadSchedule schedule;
+};
+ThreadReport audioThreadReport;
+ThreadReport renderThreadReports[MAX_TRACKS];
+std::atomic<unsigned int> audioThreadSetups{0}; // one per stream started
+std::string memoryLockStatus;
 
 void LoadBackgroundTexture() {
     int n;
@@ -219,53 +511,855 @@ void computeFFT(const std::vector<float>& in, std::vector<float>& out) {
     }
 }
 
-int audioCallback(void* outputBuffer, void*, unsigned int nBufferFrames, double, RtAudioStreamStatus, void*) {
-    float* out = reinterpret_cast<float*>(outputBuffer);
-    for (unsigned int i = 0; i < nBufferFrames; ++i) {
-        if (trigger_requested.exchange(false)) {
-            std::lock_guard<std::mutex> lock(param_mutex);
-            models[selected_model_index]->Trigger();
-            if (!gWaveformContinuous) {
+// Captured samples go to the GUI in chunks through a lock-free ring, which
+// the GUI drains into waveformPyramid every frame. A new triggered capture
+// bumps the generation; the GUI clears the pyramid on the first chunk of a
+// new generation, so the restart survives a chunk dropped on a full ring.
+constexpr size_t WAVEFORM_CHUNK = 256;
+struct WaveformChunk {
+    uint32_t generation = 0;
+    uint32_t count = 0;
+    float samples[WAVEFORM_CHUNK];
+};
+// About 0.7 s of audio, more than the GUI's idle redraw interval
+SpscQueue<WaveformChunk, 128> waveformChunks;
+WaveformChunk waveformPending; // audio thread
+
+static void FlushWaveformChunk(WaveformChunk& chunk) {
+    if (chunk.count == 0) return;
+    waveformChunks.Push(chunk); // dropped when the GUI falls behind
+    chunk.count = 0;
+}
+
+// GUI thread
+static void DrainWaveformChunks() {
+    static uint32_t generation = 0;
+    static WaveformChunk chunk;
+    while (waveformChunks.Pop(chunk)) {
+        if (chunk.generation != generation) {
+            waveformPyramid.Clear();
+            generation = chunk.generation;
+        }
+        waveformPyramid.Push(chunk.samples, chunk.count);
+    }
+}
+
+double NowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+void RequestTrigger(size_t track) {
+    triggerQueue.Push({(uint32_t)track, NowSeconds()});
+}
+
+// Applies queued edits meant for audioKit. A change made on a kit the audio
+// thread has not picked up yet is held until it has.
+static void ApplyParamChanges() {
+    static ParamChange held;
+    static bool holding = false;
+    uint32_t touched = 0;
+    while (holding || paramChanges.Pop(held)) {
+        holding = held.generation > audioKit->generation;
+        if (holding) break;
+        if (held.generation < audioKit->generation || held.track >= audioKit->models.size()) continue;
+        // A locked parameter keeps its value until the hit is over
+        StepLocks& base = lockedBase[held.track];
+        bool locked = false;
+        for (size_t i = 0; i < base.count; ++i) {
+            if (base.locks[i].param == held.param) {
+                base.locks[i].value = held.value;
+                locked = true;
+            }
+        }
+        if (locked || modMatrix.SetBase(held.track, held.param, held.value)) continue;
+        DrumModel& model = *audioKit->models[held.track];
+        if (paramSmoothers[held.track].Ramp(model, held.param, held.value)) continue;
+        model.assignParameter(held.param, held.value);
+        touched |= 1u << held.track;
+    }
+    for (size_t t = 0; touched; ++t, touched >>= 1) {
+        if (touched & 1) audioKit->models[t]->UpdateCoefficients();
+    }
+}
+
+// Value of a parameter of audioKit without modulation
+static float BaseValue(size_t track, uint16_t param) {
+    float value;
+    if (modMatrix.GetBase(track, param, &value)) return value;
+    return audioKit->models[track]->getParameter(param);
+}
+
+// Takes effect right away, modulation follows from the next control tick
+static void SetBaseValue(size_t track, uint16_t param, float value) {
+    modMatrix.SetBase(track, param, value, true);
+    audioKit->models[track]->assignParameter(param, value);
+}
+
+// Puts back what the previous hit on the track locked, then applies this
+// hit's locks. Unlocked hits in a row cost nothing. A modulated parameter
+// is modulated around its locked value.
+static void ApplyLocks(size_t track, const StepLocks& locks) {
+    StepLocks& base = lockedBase[track];
+    if (base.count == 0 && locks.count == 0) return;
+    DrumModel& model = *audioKit->models[track];
+    for (size_t i = 0; i < base.count; ++i) SetBaseValue(track, base.locks[i].param, base.locks[i].value);
+    base.count = 0;
+    for (size_t i = 0; i < locks.count; ++i) {
+        uint16_t param = locks.locks[i].param;
+        if (param >= model.getParameterCount()) continue;
+        paramSmoothers[track].Finish(model, param);
+        base.locks[base.count++] = {param, BaseValue(track, param)};
+        SetBaseValue(track, param, locks.locks[i].value);
+    }
+    model.UpdateCoefficients();
+}
+
+// Triggers of one block, in time order
+struct ScheduledTrigger {
+    unsigned int offset;
+    uint32_t track;
+    StepLocks locks;
+};
+
+// One chunk of a block, as seen by the tracks rendering it
+struct RenderJob {
+    const ScheduledTrigger* due; // the block's triggers
+    size_t numDue;
+    size_t firstDue;             // first trigger in this chunk
+    unsigned int begin, frames;  // chunk within the block
+    unsigned int fadePos, ringLen, fadeLen; // outgoing kit: rings for ringLen, then fades over fadeLen
+    size_t tracks[MAX_TRACKS];   // tracks that sound or start in the chunk
+};
+
+// Renders one track of the job into its buffer: its triggers, parameter
+// ramps and modulation, its voices and the tail of the outgoing kit, then its
+// insert chain. Runs on any render thread and only touches the track's own
+// state.
+static void RenderTrack(size_t index, void* context) {
+    RealtimeScope realtime;
+    const RenderJob& job = *static_cast<const RenderJob*>(context);
+    size_t t = job.tracks[index];
+    DrumModel& model = *audioKit->models[t];
+    char& voiced = audioKit->voiced[t];
+    float* buffer = trackBuffers[t];
+    size_t nextDue = job.firstDue;
+    for (unsigned int i = 0; i < job.frames; ++i) {
+        paramSmoothers[t].Step();
+        modMatrix.Step(t, i);
+        for (; nextDue < job.numDue && job.due[nextDue].offset == job.begin + i; ++nextDue) {
+            const ScheduledTrigger& trigger = job.due[nextDue];
+            if (trigger.track != t) continue;
+            ApplyLocks(t, trigger.locks);
+            if (renderCache.enabled() && renderCache.StartVoice(t, RenderCache::Key(t, model))) {
+                voiced = false; // the model rests while its render plays
+            } else {
+                renderCache.StopVoice(t);
+                model.Trigger();
+                voiced = true;
+            }
+        }
+        // The outgoing kit plays on at full level until its voice goes
+        // quiet, unless it has to fade. The new kit plays alongside it,
+        // since its voices only start on fresh triggers.
+        unsigned int pos = job.fadePos + i;
+        float fadeGain = 1.0f;
+        if (pos >= job.ringLen) fadeGain = pos - job.ringLen < job.fadeLen ? 1.0f - (float)(pos - job.ringLen) / (float)job.fadeLen : 0.0f;
+        float trackSample = voiced ? model.Process() : 0.0f;
+        if (renderCache.VoiceActive(t)) trackSample += renderCache.Render(t, fadeGain);
+        if (fadingKit && fadingKit->voiced[t]) {
+            float tail = fadingKit->models[t]->Process();
+            kitQuietFrames[t] = std::fabs(tail) < KIT_SILENCE_LEVEL ? kitQuietFrames[t] + 1 : 0;
+            if (fadeGain <= 0.0f || kitQuietFrames[t] >= KIT_SILENCE_FRAMES) fadingKit->voiced[t] = false;
+            trackSample += fadeGain * tail;
+        }
+        buffer[i] = trackSample;
+    }
+    trackInserts[t].Process(buffer, job.frames);
+    for (unsigned int i = 0; i < job.frames; ++i) trackMeters[t].Process(buffer[i]);
+}
+
+// Runs on each new stream's callback thread before its first block. Until
+// then the report describes the previous stream's thread.
+void SetUpAudioThread() {
+    audioThreadReport.ready.store(false, std::memory_order_relaxed);
+    audioThreadReport.error = ConfigureCurrentThread(engineOptions.rtPriority, engineOptions.audioCpu);
+    PrefaultStack();
+    audioThreadReport.schedule = CurrentThreadSchedule();
+    audioThreadReport.ready.store(true, std::memory_order_release);
+    audioThreadSetups.fetch_add(1, std::memory_order_release);
+}
+
+// Called by whichever stream's callback owns the engine; the engine keeps
+// its state when the device changes. Nothing in here may allocate, take a
+// lock (rand() included) or wait on the GUI: data goes to and from the GUI
+// through atomics and SPSC queues only. Builds with ALLOCATION_GUARD report
+// allocations; locks are not detected, so new code needs checking by hand.
+void RenderAudio(float* out, unsigned int nBufferFrames, unsigned int channels) {
+    RealtimeScope realtime;
+    WaveformChunk& waveChunk = waveformPending;
+    size_t recordCount = 0;
+    static unsigned int fadePos = 0, ringLen = 0, fadeLen = 0;
+
+    // Kit switches happen here, between blocks, and never wait on the GUI.
+    // The outgoing kit is retired once all its tails have ended; a kit
+    // waiting behind it makes them fade now.
+    if (fadingKit) {
+        bool ringing = fadePos < ringLen + fadeLen &&
+                       std::any_of(fadingKit->voiced.begin(), fadingKit->voiced.end(), [](char v) { return v != 0; });
+        if (!ringing && kitExchange.Retire(fadingKit)) {
+            fadingKit = nullptr;
+        } else if (ringing && fadePos < ringLen && kitExchange.Pending()) {
+            ringLen = fadePos;
+            fadeLen = (unsigned int)(gKitCrossfadeMs.load(std::memory_order_relaxed) * SAMPLE_RATE / 1000.0f);
+        }
+    }
+    if (!fadingKit) {
+        if (DrumKit* next = kitExchange.Acquire()) {
+            renderCache.FadeVoices();
+            modMatrix.Reset();
+            for (StepLocks& base : lockedBase) base.count = 0;
+            std::fill(kitQuietFrames, kitQuietFrames + MAX_TRACKS, 0u);
+            fadingKit = audioKit;
+            audioKit = next;
+            fadePos = 0;
+            ringLen = (unsigned int)(KIT_RING_SECONDS * SAMPLE_RATE);
+            fadeLen = (unsigned int)(gKitCrossfadeMs.load(std::memory_order_relaxed) * SAMPLE_RATE / 1000.0f);
+        }
+    }
+    if (!audioKit) {
+        std::fill(out, out + channels * nBufferFrames, 0.0f);
+        return;
+    }
+    ApplyParamChanges();
+    // Tracks start sounding on their first trigger
+    char* trackVoiced = audioKit->voiced.data();
+    size_t numTracks = std::min(audioKit->models.size(), MAX_TRACKS);
+
+    // Place queued triggers at the same position within this block that they
+    // had within the previous block period. Latency is then a constant one
+    // buffer instead of being quantized to block or frame boundaries.
+    ScheduledTrigger due[MAX_BLOCK_TRIGGERS];
+    size_t numDue = 0;
+    double blockStart = NowSeconds();
+    double prevBlockStart = blockStart - nBufferFrames / (double)SAMPLE_RATE;
+    auto schedule = [&](unsigned int offset, size_t track, const StepLocks& locks) {
+        if (numDue == MAX_BLOCK_TRIGGERS || track >= numTracks) return;
+        size_t k = numDue++;
+        while (k > 0 && due[k - 1].offset > offset) { due[k] = due[k - 1]; --k; }
+        due[k] = {offset, (uint32_t)track, locks};
+    };
+    TriggerEvent ev;
+    while (numDue < MAX_BLOCK_TRIGGERS && triggerQueue.Pop(ev)) {
+        double pos = (ev.time - prevBlockStart) * SAMPLE_RATE;
+        schedule(pos <= 0.0 ? 0 : std::min((unsigned int)pos, nBufferFrames - 1), ev.track, StepLocks());
+    }
+    // Sequenced steps are already sample-exact within this block
+    sequencer.Advance(nBufferFrames, schedule);
+
+    size_t recordWidth = recorder.BeginBlock(); // 0 when not recording
+
+    // Channels are non-interleaved; the routed pairs are summed into
+    float* mainLeft = out;
+    float* mainRight = channels > 1 ? out + nBufferFrames : nullptr;
+    unsigned int routes[MAX_TRACKS];
+    for (size_t t = 0; t < numTracks; ++t) {
+        unsigned int output = (unsigned int)trackOutputs[t].load(std::memory_order_relaxed);
+        routes[t] = 2 * output + 2 <= channels ? output : 0;
+    }
+    if (channels > 2) std::fill(out + 2 * nBufferFrames, out + channels * nBufferFrames, 0.0f);
+    for (size_t t = 0; t < numTracks; ++t) paramSmoothers[t].BeginBlock(nBufferFrames);
+    renderPool.SetPeriod(nBufferFrames / (double)SAMPLE_RATE);
+    RenderJob job;
+    job.due = due;
+    job.numDue = numDue;
+    job.ringLen = ringLen;
+    job.fadeLen = fadeLen;
+    size_t nextDue = 0;
+    for (unsigned int begin = 0; begin < nBufferFrames; begin += RENDER_CHUNK) {
+        unsigned int frames = std::min(RENDER_CHUNK, nBufferFrames - begin);
+        job.begin = begin;
+        job.frames = frames;
+        job.firstDue = nextDue;
+        job.fadePos = fadePos;
+
+        // Plan the modulation and find the tracks that have work to do
+        bool starts[MAX_TRACKS] = {};
+        modMatrix.BeginBlock(audioKit->models, frames);
+        for (size_t k = nextDue; k < numDue && due[k].offset < begin + frames; ++k) {
+            modMatrix.Trigger(due[k].track, due[k].offset - begin);
+            starts[due[k].track] = true;
+        }
+        modMatrix.Plan();
+        size_t numJobTracks = 0;
+        for (size_t t = 0; t < numTracks; ++t) {
+            if (starts[t] || trackVoiced[t] || renderCache.VoiceActive(t) || (fadingKit && fadingKit->voiced[t])) {
+                job.tracks[numJobTracks++] = t;
+            }
+        }
+        if (numJobTracks * frames >= PARALLEL_MIN_WORK) {
+            renderPool.Run(numJobTracks, &RenderTrack, &job);
+        } else {
+            for (size_t j = 0; j < numJobTracks; ++j) RenderTrack(j, &job);
+        }
+        fadePos = std::min(fadePos + frames, ringLen + fadeLen);
+
+        // Pan each track onto the main bus or its own pair and into the sends;
+        // the kit mix has every track, wherever it is routed
+        float busLeft[RENDER_CHUNK] = {}, busRight[RENDER_CHUNK] = {};
+        float kitLeft[RENDER_CHUNK] = {}, kitRight[RENDER_CHUNK] = {};
+        float reverbBus[RENDER_CHUNK] = {}, delayBus[RENDER_CHUNK] = {};
+        for (size_t j = 0; j < numJobTracks; ++j) {
+            size_t t = job.tracks[j];
+            const float* x = trackBuffers[t];
+            float* left = busLeft;
+            float* right = busRight;
+            if (unsigned int output = routes[t]) {
+                left = out + 2 * output * nBufferFrames + begin;
+                right = left + nBufferFrames;
+            }
+            MixGains g = mixGains[t];
+            MixGains target = TargetGains(trackMix[t]);
+            float step = 1.0f / frames;
+            float dl = (target.left - g.left) * step, dr = (target.right - g.right) * step;
+            float dv = (target.reverb - g.reverb) * step, dd = (target.delay - g.delay) * step;
+            for (unsigned int i = 0; i < frames; ++i) {
+                g.left += dl;
+                g.right += dr;
+                g.reverb += dv;
+                g.delay += dd;
+                float l = x[i] * g.left, r = x[i] * g.right;
+                left[i] += l;
+                right[i] += r;
+                kitLeft[i] += l;
+                kitRight[i] += r;
+                reverbBus[i] += x[i] * g.reverb;
+                delayBus[i] += x[i] * g.delay;
+            }
+            mixGains[t] = target;
+        }
+        float returnLeft[RENDER_CHUNK] = {}, returnRight[RENDER_CHUNK] = {};
+        reverb.Process(reverbBus, returnLeft, returnRight, frames);
+        delay.Process(delayBus, returnLeft, returnRight, frames, sequencer.tempo());
+
+        float mix[RENDER_CHUNK];
+        for (unsigned int i = 0; i < frames; ++i) {
+            bool triggered = false;
+            for (; nextDue < numDue && due[nextDue].offset == begin + i; ++nextDue) triggered = true;
+            if (triggered && !gWaveformContinuous) {
                 gWaveformCaptureActive = true;
                 gWaveformCapturedSamples = 0;
-                std::lock_guard<std::mutex> lock2(waveformMutex);
-                waveformBuffer.clear();
+                waveChunk.count = 0;
+                ++waveChunk.generation;
             }
-        }
-        float sample = models[selected_model_index]->Process();
-        out[2 * i] = sample;     // Left channel
-        out[2 * i + 1] = sample; // Right channel
-        // Store sample for waveform display
-        if (gWaveformContinuous) {
-            std::lock_guard<std::mutex> lock(waveformMutex);
-            waveformBuffer.push_back(sample);
-            if (waveformBuffer.size() > WAVEFORM_BUFFER_SIZE) {
-                waveformBuffer.pop_front();
+            // The meters, scope and recorder take the whole kit
+            float left = kitLeft[i] + returnLeft[i];
+            float right = kitRight[i] + returnRight[i];
+            float sample = 0.5f * (left + right);
+            if (recordWidth) {
+                float* recordFrame = recordChunk + recordCount * recordWidth;
+                std::fill(recordFrame, recordFrame + recordWidth, 0.0f);
+                for (size_t j = 0; j < numJobTracks; ++j) {
+                    size_t t = job.tracks[j];
+                    if (2 + t < recordWidth) recordFrame[2 + t] = trackBuffers[t][i];
+                }
+                recordFrame[0] = left;
+                recordFrame[1] = right;
+                if (++recordCount == RECORD_CHUNK) {
+                    recorder.Push(recordChunk, recordCount);
+                    recordCount = 0;
+                }
+            }
+            masterMeter.Process(std::fabs(left) > std::fabs(right) ? left : right);
+            busLeft[i] += returnLeft[i];
+            busRight[i] += returnRight[i];
+            // Store sample for waveform display
+            if (gWaveformContinuous) {
+                waveChunk.samples[waveChunk.count++] = sample;
+            } else {
+                if (gWaveformCaptureActive) {
+                    waveChunk.samples[waveChunk.count++] = sample;
+                    gWaveformCapturedSamples++;
+                    if (gWaveformCapturedSamples >= WAVEFORM_BUFFER_SIZE) {
+                        gWaveformCaptureActive = false;
+                    }
+                }
             }
+            if (waveChunk.count == WAVEFORM_CHUNK) FlushWaveformChunk(waveChunk);
+            mix[i] = sample;
+        }
+        fftTap.Write(mix, frames);
+
+        limiter.Process(busLeft, busRight, frames);
+        routedDelay.SetDelay(limiter.latency());
+        for (unsigned int c = 2; c < channels; ++c) routedDelay.Process(c - 2, out + c * nBufferFrames + begin, frames);
+        if (mainRight) {
+            std::copy(busLeft, busLeft + frames, mainLeft + begin);
+            std::copy(busRight, busRight + frames, mainRight + begin);
         } else {
-            if (gWaveformCaptureActive) {
-                std::lock_guard<std::mutex> lock(waveformMutex);
-                waveformBuffer.push_back(sample);
-                gWaveformCapturedSamples++;
-                if (gWaveformCapturedSamples >= WAVEFORM_BUFFER_SIZE) {
-                    gWaveformCaptureActive = false;
+            for (unsigned int i = 0; i < frames; ++i) mainLeft[begin + i] = 0.5f * (busLeft[i] + busRight[i]);
+        }
+    }
+    for (size_t t = 0; t < numTracks; ++t) paramSmoothers[t].EndBlock();
+    // Full chunks only, so small buffers do not flood the ring; the tail of
+    // a finished triggered capture goes out at once
+    if (!gWaveformContinuous && !gWaveformCaptureActive) FlushWaveformChunk(waveChunk);
+    if (recordWidth) {
+        if (recordCount) recorder.Push(recordChunk, recordCount);
+        recorder.EndBlock();
+    }
+    // Publish meters once per block; tracks that never played just decay
+    for (size_t t = 0; t < numTracks; ++t) {
+        if (!trackVoiced[t] && !fadingKit && !renderCache.VoiceActive(t)) trackMeters[t].Idle(nBufferFrames);
+        trackMeters[t].Publish();
+    }
+    masterMeter.Publish();
+}
+
+AudioOutput audioOutput(SAMPLE_RATE, &RenderAudio, &SetUpAudioThread);
+
+// Horizontal meter bar: RMS as the filled bar, peak in the overlay text (dBFS)
+void LevelMeterBar(const char* label, const LevelMeter& meter) {
+    float rms = meter.rms();
+    float peak = meter.peak();
+    float peakDb = 20.0f * log10f(std::max(peak, 1e-5f));
+    char overlay[48];
+    snprintf(overlay, sizeof(overlay), "%s  peak %.1f dB", label, peakDb);
+    ImGui::ProgressBar(std::min(1.0f, rms * 1.41421356f), ImVec2(-1, 0), overlay);
+}
+
+// Limiter gain reduction, full bar at 12 dB
+void LimiterBar() {
+    float reduction = limiter.reduction();
+    char overlay[48];
+    if (limiter.enabled()) {
+        snprintf(overlay, sizeof(overlay), "Limiter  -%.1f dB", reduction);
+    } else {
+        snprintf(overlay, sizeof(overlay), "Limiter  off");
+    }
+    ImGui::ProgressBar(std::min(1.0f, reduction / 12.0f), ImVec2(-1, 0), overlay);
+}
+
+ParamSnapshot SnapshotParameters() {
+    std::lock_guard<std::mutex> lock(param_mutex);
+    return CaptureParams(models);
+}
+
+void SaveParameters(const char* path) {
+    paramSaver.Save(path, SnapshotParameters());
+}
+
+// Writes the autosave file when parameters changed since the last one
+void Autosave(double now) {
+    static double lastCheck = 0.0;
+    if (!gAutosave || now - lastCheck < AUTOSAVE_INTERVAL) return;
+    lastCheck = now;
+    ParamSnapshot snapshot = SnapshotParameters();
+    if (snapshot == lastAutosaved) return;
+    lastAutosaved = snapshot;
+    paramSaver.Save(autosave_file, std::move(snapshot));
+}
+
+// Requests a render for every track whose parameters changed since its last request
+void UpdateRenderCache() {
+    if (!gRenderCache) return;
+    ParamSnapshot params = SnapshotParameters();
+    for (size_t t = 0; t < params.size() && t < MAX_TRACKS; ++t) {
+        uint64_t key = RenderCache::Key(t, params[t]);
+        if (key == renderCacheKeys[t]) continue;
+        renderCacheKeys[t] = key;
+        renderCache.Request(t, key, std::move(params[t]));
+    }
+}
+
+// A fresh kit carrying the current parameters, to be changed and staged
+std::unique_ptr<DrumKit> CopyCurrentKit() {
+    std::unique_ptr<DrumKit> kit = CreateDrumKit();
+    ParamSnapshot values = SnapshotParameters();
+    for (size_t m = 0; m < values.size() && m < kit->models.size(); ++m) {
+        for (size_t p = 0; p < values[m].size(); ++p) kit->models[m]->setParameter(p, values[m][p]);
+    }
+    return kit;
+}
+
+// Brings derived state in line with the kit's parameters
+void FinishKit(DrumKit& kit) {
+    for (auto& model : kit.models) {
+        model->UpdateCoefficients();
+        model->Init();
+    }
+}
+
+// Finishes a kit off the audio thread and hands a copy over. The GUI edits
+// the new models from now on; the audio thread switches at its next block.
+void StageKit(std::unique_ptr<DrumKit> kit) {
+    FinishKit(*kit);
+    std::lock_guard<std::mutex> lock(reloadMutex);
+    reloadedModels.clear();
+    kit->generation = ++lastGeneration;
+    models = kit->models;
+    guiGeneration = kit->generation;
+    sentParams = CaptureParams(models);
+    kitExchange.Stage(CopyDrumKit(*kit));
+}
+
+// Watcher thread: reloads param_file unless it is unchanged or invalid
+void ReloadParameterFile() {
+    std::ifstream ifs(param_file, std::ios::binary);
+    if (!ifs) return;
+    std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    ParamSnapshot values;
+    std::string error;
+    bool valid = ParseParams(text, trackParamCounts, values, &error);
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        if (text == paramFileText) return; // our own save, or a repeated event
+        if (!valid) {
+            reloadStatus = std::string(param_file) + " " + error + ", kept current kit";
+            return;
+        }
+    }
+    std::unique_ptr<DrumKit> kit = CreateDrumKit();
+    for (size_t m = 0; m < values.size(); ++m) {
+        for (size_t p = 0; p < values[m].size(); ++p) kit->models[m]->setParameter(p, values[m][p]);
+    }
+    FinishKit(*kit);
+    std::lock_guard<std::mutex> lock(reloadMutex);
+    paramFileText = std::move(text);
+    kit->generation = ++lastGeneration;
+    reloadedModels = kit->models;
+    reloadedGeneration = kit->generation;
+    reloadStatus = std::string("Reloaded ") + param_file;
+    kitExchange.Stage(CopyDrumKit(*kit));
+}
+
+void AdoptReloadedKit() {
+    std::lock_guard<std::mutex> lock(reloadMutex);
+    if (reloadedModels.empty()) return;
+    models = std::move(reloadedModels);
+    reloadedModels.clear();
+    guiGeneration = reloadedGeneration;
+    sentParams = CaptureParams(models);
+}
+
+// Sends every parameter changed in the GUI since the last frame to the audio kit
+void SyncParameters() {
+    std::lock_guard<std::mutex> lock(param_mutex);
+    for (size_t t = 0; t < models.size() && t < sentParams.size(); ++t) {
+        for (size_t p = 0; p < sentParams[t].size(); ++p) {
+            float value = models[t]->getParameter(p);
+            if (value == sentParams[t][p]) continue;
+            // When the queue is full the rest goes out next frame
+            if (!paramChanges.Push({guiGeneration, (uint16_t)t, (uint16_t)p, value})) return;
+            sentParams[t][p] = value;
+        }
+    }
+}
+
+void SetParamFileWatch(bool enabled) {
+    if (enabled && !paramWatcher) {
+        paramWatcher = std::make_unique<FileWatcher>(param_file, ReloadParameterFile);
+    } else if (!enabled) {
+        paramWatcher.reset();
+    }
+}
+
+void LoadParameters(const char* path) {
+    std::ifstream ifs(path);
+    if (!ifs) return;
+    std::unique_ptr<DrumKit> kit = CopyCurrentKit();
+    for (const auto& model : kit->models) {
+        model->loadParameters(ifs);
+    }
+    StageKit(std::move(kit));
+}
+
+void LoadKitFromBank(size_t index) {
+    std::unique_ptr<DrumKit> kit = CopyCurrentKit();
+    if (kitBank.ApplyKit(index, kit->models)) {
+        StageKit(std::move(kit));
+        kitBankStatus = "Loaded " + kitBank.kitName(index);
+    } else {
+        kitBankStatus = "Kit " + std::to_string(index) + " is missing or corrupt";
+    }
+}
+
+// Rewrites the bank with the current parameters appended as a new kit
+void StoreKitInBank() {
+    std::vector<PresetBank::Kit> kits(kitBank.kitCount());
+    for (size_t k = 0; k < kits.size(); ++k) kitBank.ReadKit(k, kits[k]);
+    {
+        std::lock_guard<std::mutex> lock(param_mutex);
+        kits.push_back(PresetBank::CaptureKit("Kit " + std::to_string(kits.size()), models));
+    }
+    kitBank.Close();
+    std::string error;
+    if (!PresetBank::WriteBank(bank_file, kits, &error)) {
+        kitBankStatus = error;
+    } else {
+        kitBankIndex = (int)kits.size() - 1;
+        kitBankStatus = "Stored " + kits.back().name;
+    }
+    kitBank.Open(bank_file);
+}
+
+void ShowKitBank() {
+    if (!ImGui::CollapsingHeader("Kit Bank")) return;
+    size_t count = kitBank.kitCount();
+    ImGui::Text("%s: %zu kits", bank_file, count);
+    if (count > 0) {
+        ImGui::InputInt("Kit", &kitBankIndex);
+        kitBankIndex = std::max(0, std::min(kitBankIndex, (int)count - 1));
+        ImGui::Text("%s", kitBank.kitName(kitBankIndex).c_str());
+        if (ImGui::Button("Load Kit")) LoadKitFromBank(kitBankIndex);
+        ImGui::SameLine();
+    }
+    if (ImGui::Button("Store As New Kit")) StoreKitInBank();
+    float crossfadeMs = gKitCrossfadeMs;
+    if (ImGui::SliderFloat("Tail fade (ms)", &crossfadeMs, 0.0f, 50.0f, "%.1f")) gKitCrossfadeMs = crossfadeMs;
+    if (!kitBankStatus.empty()) ImGui::TextWrapped("%s", kitBankStatus.c_str());
+}
+
+void ShowRecorder() {
+    if (!ImGui::CollapsingHeader("Recorder")) return;
+    if (!recorder.isRecording()) {
+        const char* formats[] = {"32-bit float", "24-bit PCM"};
+        ImGui::Combo("Format", &gRecordFormat, formats, 2);
+        ImGui::Checkbox("Also record each track", &gRecordTracks);
+        if (ImGui::Button("Record")) {
+            char basename[64];
+            std::time_t now = std::time(nullptr);
+            std::strftime(basename, sizeof(basename), "take_%Y%m%d_%H%M%S", std::localtime(&now));
+            std::vector<std::string> trackNames;
+            if (gRecordTracks) trackNames = model_names;
+            std::string error;
+            if (recorder.Start(basename, (WavRecorder::Format)gRecordFormat, trackNames, SAMPLE_RATE, &error)) {
+                recorderStatus = std::string("Recording ") + basename + ".wav";
+            } else {
+                recorderStatus = error;
+            }
+        }
+    } else if (ImGui::Button("Stop")) {
+        recorder.Stop();
+    }
+    if (!recorderStatus.empty()) ImGui::TextWrapped("%s", recorderStatus.c_str());
+    ImGui::Text("%.1f s recorded, %llu overruns (%llu frames dropped)",
+                recorder.framesRecorded() / SAMPLE_RATE,
+                (unsigned long long)recorder.overruns(), (unsigned long long)recorder.droppedFrames());
+}
+
+void ShowRenderCache() {
+    if (!ImGui::CollapsingHeader("Render Cache")) return;
+    if (ImGui::Checkbox("Play hits from pre-rendered buffers", &gRenderCache)) {
+        renderCache.SetEnabled(gRenderCache);
+        std::fill(renderCacheKeys, renderCacheKeys + MAX_TRACKS, 0);
+    }
+    if (ImGui::SliderInt("Budget (MB)", &gRenderCacheBudgetMb, 8, 512)) {
+        renderCache.SetBudget((size_t)gRenderCacheBudgetMb << 20);
+    }
+    ImGui::Text("%zu renders, %.1f MB, %llu hits, %llu misses", renderCache.entryCount(),
+                renderCache.bytesUsed() / 1048576.0, (unsigned long long)renderCache.hits(),
+                (unsigned long long)renderCache.misses());
+}
+
+// LFO of the selected track, then the matrix slots routing any LFO to any
+// track's parameter
+void ShowModulation() {
+    if (!ImGui::CollapsingHeader("Modulation")) return;
+    size_t track = selected_model_index;
+    ModMatrix::LfoSettings lfo = modMatrix.lfo(track);
+    const char* waveforms[] = {"Triangle", "Ramp Down", "Ramp Up", "Square", "Sine", "Sample & Hold"};
+    bool changed = ImGui::SliderInt("LFO Rate", &lfo.rate, 0, 99);
+    changed |= ImGui::SliderInt("LFO Delay", &lfo.delay, 0, 99);
+    changed |= ImGui::Combo("LFO Wave", &lfo.waveform, waveforms, 6);
+    changed |= ImGui::Checkbox("Restart on hit", &lfo.retrigger);
+    if (changed) modMatrix.SetLfo(track, lfo);
+
+    std::lock_guard<std::mutex> lock(param_mutex);
+    for (size_t i = 0; i < ModMatrix::kSlots; ++i) {
+        ModMatrix::Slot slot = modMatrix.slot(i);
+        if (slot.source >= (int)models.size()) slot.source = -1;
+        if (slot.track >= (int)models.size()) slot.track = 0;
+        bool edited = false;
+        ImGui::PushID((int)i);
+        ImGui::Text("%zu", i + 1);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90.0f);
+        if (ImGui::BeginCombo("##source", slot.source < 0 ? "Off" : ("LFO " + model_names[slot.source]).c_str())) {
+            if (ImGui::Selectable("Off", slot.source < 0)) slot.source = -1, edited = true;
+            for (size_t t = 0; t < model_names.size(); ++t) {
+                if (ImGui::Selectable(("LFO " + model_names[t]).c_str(), slot.source == (int)t)) slot.source = (int)t, edited = true;
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::BeginDisabled(slot.source < 0);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90.0f);
+        if (ImGui::BeginCombo("##track", model_names[slot.track].c_str())) {
+            for (size_t t = 0; t < model_names.size(); ++t) {
+                if (ImGui::Selectable(model_names[t].c_str(), slot.track == (int)t)) {
+                    if (slot.track != (int)t) slot.param = 0;
+                    slot.track = (int)t;
+                    edited = true;
                 }
             }
+            ImGui::EndCombo();
         }
-        // Collect samples for FFT
-        {
-            std::lock_guard<std::mutex> lock(fftMutex);
-            fftInputBuffer.push_back(sample);
-            if (fftInputBuffer.size() > FFT_SIZE) {
-                fftInputBuffer.erase(fftInputBuffer.begin(), fftInputBuffer.begin() + (fftInputBuffer.size() - FFT_SIZE));
+        DrumModel& model = *models[slot.track];
+        if (slot.param >= (int)model.getParameterCount()) slot.param = 0;
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(110.0f);
+        if (ImGui::BeginCombo("##param", model.getParameterDesc(slot.param).name)) {
+            for (size_t id = 0; id < model.getParameterCount(); ++id) {
+                if (ImGui::Selectable(model.getParameterDesc(id).name, slot.param == (int)id)) slot.param = (int)id, edited = true;
             }
+            ImGui::EndCombo();
         }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(-1.0f);
+        edited |= ImGui::SliderFloat("##depth", &slot.depth, -1.0f, 1.0f, "%.2f");
+        ImGui::EndDisabled();
+        if (edited) modMatrix.SetSlot(i, slot);
+        ImGui::PopID();
+    }
+}
+
+// Insert chain of the selected track
+void ShowInsert() {
+    if (!ImGui::CollapsingHeader("Insert")) return;
+    TrackInsert& insert = trackInserts[selected_model_index];
+    TrackInsert::Settings s = insert.settings();
+    bool changed = false;
+    if (ImGui::BeginCombo("Filter", TrackInsert::FilterModeName(s.filterMode))) {
+        for (int mode = 0; mode < TrackInsert::NUM_FILTER_MODES; ++mode) {
+            if (ImGui::Selectable(TrackInsert::FilterModeName(mode), s.filterMode == mode)) s.filterMode = mode, changed = true;
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::BeginDisabled(s.filterMode == TrackInsert::FILTER_OFF);
+    char cutoff[32];
+    snprintf(cutoff, sizeof(cutoff), "%.0f Hz", 20.0f * std::pow(1000.0f, s.cutoff));
+    changed |= ImGui::SliderFloat("Cutoff", &s.cutoff, 0.0f, 1.0f, cutoff);
+    changed |= ImGui::SliderFloat("Resonance", &s.resonance, 0.0f, 1.0f, "%.2f");
+    ImGui::EndDisabled();
+    changed |= ImGui::SliderFloat("Drive", &s.drive, 0.0f, 1.0f, "%.2f");
+    ImGui::BeginDisabled(s.drive == 0.0f);
+    changed |= ImGui::SliderFloat("Shape", &s.shape, 0.0f, 1.0f, "%.2f");
+    ImGui::EndDisabled();
+    changed |= ImGui::SliderFloat("Fold", &s.fold, 0.0f, 1.0f, "%.2f");
+    const char* curves[] = {"Sine Fold", "Cosine Fold"};
+    ImGui::BeginDisabled(s.fold == 0.0f);
+    changed |= ImGui::Combo("Fold Curve", &s.foldCurve, curves, TrackInsert::NUM_FOLD_CURVES);
+    ImGui::EndDisabled();
+    if (changed) insert.Set(s);
+}
+
+void ShowLimiter() {
+    if (!ImGui::CollapsingHeader("Limiter")) return;
+    bool enabled = limiter.enabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) limiter.SetEnabled(enabled);
+    ImGui::BeginDisabled(!enabled);
+    float ceiling = limiter.ceiling();
+    if (ImGui::SliderFloat("Ceiling", &ceiling, -12.0f, 0.0f, "%.1f dBTP")) limiter.SetCeiling(ceiling);
+    float lookahead = limiter.lookahead();
+    if (ImGui::SliderFloat("Lookahead", &lookahead, LookaheadLimiter::kMinLookaheadMs, LookaheadLimiter::kMaxLookaheadMs,
+                           "%.1f ms")) {
+        limiter.SetLookahead(lookahead);
+    }
+    float release = limiter.release();
+    if (ImGui::SliderFloat("Release", &release, 10.0f, 1000.0f, "%.0f ms", ImGuiSliderFlags_Logarithmic)) {
+        limiter.SetRelease(release);
+    }
+    ImGui::EndDisabled();
+}
+
+// Pan and sends per track, then the two send effects
+void ShowMixer() {
+    if (!ImGui::CollapsingHeader("Mixer")) return;
+    if (ImGui::BeginTable("mixer", 4, ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Track", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+        ImGui::TableSetupColumn("Pan");
+        ImGui::TableSetupColumn("Reverb");
+        ImGui::TableSetupColumn("Delay");
+        ImGui::TableHeadersRow();
+        for (size_t t = 0; t < model_names.size() && t < MAX_TRACKS; ++t) {
+            TrackMix& mix = trackMix[t];
+            ImGui::PushID((int)t);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(model_names[t].c_str());
+            auto slider = [](const char* id, std::atomic<float>& value, float min, float max) {
+                float v = value.load(std::memory_order_relaxed);
+                ImGui::SetNextItemWidth(-1.0f);
+                if (ImGui::SliderFloat(id, &v, min, max, "%.2f")) value.store(v, std::memory_order_relaxed);
+            };
+            ImGui::TableNextColumn();
+            slider("##pan", mix.pan, -1.0f, 1.0f);
+            ImGui::TableNextColumn();
+            slider("##reverb", mix.reverbSend, 0.0f, 1.0f);
+            ImGui::TableNextColumn();
+            slider("##delay", mix.delaySend, 0.0f, 1.0f);
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    float decay = reverb.decay(), damping = reverb.damping();
+    if (ImGui::SliderFloat("Reverb Decay (s)", &decay, 0.1f, 20.0f, "%.1f", ImGuiSliderFlags_Logarithmic)) reverb.SetDecay(decay);
+    if (ImGui::SliderFloat("Reverb Damping", &damping, 0.0f, 1.0f, "%.2f")) reverb.SetDamping(damping);
+    if (ImGui::BeginCombo("Delay Time", TempoDelay::DivisionName(delay.division()))) {
+        for (int d = 0; d < TempoDelay::NUM_DIVISIONS; ++d) {
+            if (ImGui::Selectable(TempoDelay::DivisionName(d), delay.division() == d)) delay.SetDivision(d);
+        }
+        ImGui::EndCombo();
+    }
+    float feedback = delay.feedback(), tone = delay.tone();
+    if (ImGui::SliderFloat("Delay Feedback", &feedback, 0.0f, 0.95f, "%.2f")) delay.SetFeedback(feedback);
+    if (ImGui::SliderFloat("Delay Tone", &tone, 0.0f, 1.0f, "%.2f")) delay.SetTone(tone);
+    bool pingPong = delay.pingPong();
+    if (ImGui::Checkbox("Ping-Pong", &pingPong)) delay.SetPingPong(pingPong);
+}
+
+// Track routing to the device's channel pairs
+void ShowOutputs() {
+    if (!ImGui::CollapsingHeader("Outputs")) return;
+    AudioOutput::Settings active = audioOutput.settings();
+    unsigned int deviceChannels = 2;
+    for (const AudioOutput::Device& device : audioOutput.devices()) {
+        if ((int)device.id == active.device) deviceChannels = device.outputChannels;
+    }
+    int pairs = (int)std::min(deviceChannels, AudioOutput::kMaxChannels) / 2;
+    ImGui::TextDisabled("%u of %u device channels open", audioOutput.channels(), deviceChannels);
+    auto pairName = [](int output) {
+        return output == 0 ? std::string("Main 1/2") : std::to_string(2 * output + 1) + "/" + std::to_string(2 * output + 2);
+    };
+    bool changed = false;
+    for (size_t t = 0; t < model_names.size() && t < MAX_TRACKS; ++t) {
+        int output = trackOutputs[t].load(std::memory_order_relaxed);
+        ImGui::PushID((int)t);
+        ImGui::SetNextItemWidth(110.0f);
+        if (ImGui::BeginCombo(model_names[t].c_str(), pairName(output).c_str())) {
+            for (int pair = 0; pair < std::max(pairs, 1); ++pair) {
+                if (ImGui::Selectable(pairName(pair).c_str(), output == pair) && output != pair) {
+                    trackOutputs[t].store(pair, std::memory_order_relaxed);
+                    changed = true;
+                }
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::PopID();
+    }
+    if (changed && OutputChannelsNeeded() != active.channels) {
+        active.channels = OutputChannelsNeeded();
+        audioOutput.Open(active);
     }
-    return 0;
 }
 
 void ShowControls() {
-    ImGui::Begin("FM Drum Synth");
+    if (!ImGui::Begin("FM Drum Synth")) {
+        ImGui::End();
+        return;
+    }
 
     if (ImGui::BeginCombo("Drum Model", model_names[selected_model_index].c_str())) {
         for (size_t i = 0; i < model_names.size(); ++i) {
@@ -279,13 +1373,26 @@ void ShowControls() {
     }
 
     if (ImGui::Button("Trigger (space)")) {
-        trigger_requested = true;
+        RequestTrigger(selected_model_index);
     }
 
+    LevelMeterBar("Track", trackMeters[selected_model_index]);
+    LevelMeterBar("Master", masterMeter);
+    LimiterBar();
+    ShowKitBank();
+    ShowRecorder();
+    ShowRenderCache();
+    ShowModulation();
+    ShowInsert();
+    ShowMixer();
+    ShowLimiter();
+    ShowOutputs();
+
     CustomControls::BeginParameters();
 
     std::lock_guard<std::mutex> lock(param_mutex);
     models[selected_model_index]->RenderControls();
+    models[selected_model_index]->UpdateCoefficients();
 
     CustomControls::EndParameters();
 
@@ -296,23 +1403,24 @@ void ShowMenuBar() {
     if (ImGui::BeginMainMenuBar()) {
         if (ImGui::BeginMenu("File")) {
             if (ImGui::MenuItem("Save Parameters\tCtrl+S")) {
-                std::ofstream ofs("drum_params.txt");
-                if (ofs) {
-                    std::lock_guard<std::mutex> lock(param_mutex);
-                    for (const auto& model : models) {
-                        model->saveParameters(ofs);
-                    }
-                }
+                SaveParameters(param_file);
             }
             if (ImGui::MenuItem("Load Parameters\tCtrl+L")) {
-                std::ifstream ifs("drum_params.txt");
-                if (ifs) {
-                    std::lock_guard<std::mutex> lock(param_mutex);
-                    for (const auto& model : models) {
-                        model->loadParameters(ifs);
-                    }
-                }
+                LoadParameters(param_file);
             }
+            ImGui::MenuItem("Autosave", nullptr, &gAutosave);
+            if (ImGui::MenuItem("Watch Parameter File", nullptr, &gWatchParamFile)) {
+                SetParamFileWatch(gWatchParamFile);
+            }
+            std::string saveStatus = paramSaver.status();
+            if (!saveStatus.empty()) ImGui::TextDisabled("%s", saveStatus.c_str());
+            std::string watchStatus;
+            {
+                std::lock_guard<std::mutex> lock(reloadMutex);
+                watchStatus = reloadStatus;
+            }
+            if (!watchStatus.empty()) ImGui::TextDisabled("%s", watchStatus.c_str());
+            ImGui::Separator();
             if (ImGui::MenuItem("Quit")) {
                 // Set window should close
                 GLFWwindow* window = glfwGetCurrentContext();
@@ -321,14 +1429,78 @@ void ShowMenuBar() {
             ImGui::EndMenu();
         }
         if (ImGui::BeginMenu("Audio")) {
-            for (int i = 0; i < audioDeviceNames.size(); ++i) {
-                bool isSelected = (i == selectedAudioDeviceIdx);
-                if (ImGui::MenuItem(audioDeviceNames[i].c_str(), nullptr, isSelected)) {
-                    if (!isSelected) {
-                        selectedAudioDeviceIdx = i;
-                        audioNeedsRestart = true;
+            // Changes apply in the background, starting from the running stream
+            AudioOutput::Settings active = audioOutput.settings();
+            if (ImGui::BeginMenu("API")) {
+                std::vector<RtAudio::Api> apis;
+                RtAudio::getCompiledApi(apis);
+                for (RtAudio::Api api : apis) {
+                    bool current = active.api == api;
+                    if (ImGui::MenuItem(RtAudio::getApiDisplayName(api).c_str(), nullptr, current) && !current) {
+                        AudioOutput::Settings settings = active;
+                        settings.api = api;
+                        settings.device = -1;
+                        audioOutput.Open(settings);
                     }
                 }
+                ImGui::EndMenu();
+            }
+            if (ImGui::BeginMenu("Buffer Size")) {
+                for (unsigned int frames = 16; frames <= 2048; frames *= 2) {
+                    char label[48];
+                    snprintf(label, sizeof(label), "%u frames (%.1f ms)", frames, 1000.0f * frames / SAMPLE_RATE);
+                    if (ImGui::MenuItem(label, nullptr, active.bufferFrames == frames) && active.bufferFrames != frames) {
+                        AudioOutput::Settings settings = active;
+                        settings.bufferFrames = frames;
+                        audioOutput.Open(settings);
+                    }
+                }
+                ImGui::EndMenu();
+            }
+            if (ImGui::BeginMenu("Periods")) {
+                auto item = [&](const char* label, unsigned int periods) {
+                    if (ImGui::MenuItem(label, nullptr, active.periods == periods) && active.periods != periods) {
+                        AudioOutput::Settings settings = active;
+                        settings.periods = periods;
+                        audioOutput.Open(settings);
+                    }
+                };
+                item("Backend Default", 0);
+                for (unsigned int periods = 2; periods <= 4; ++periods) item(std::to_string(periods).c_str(), periods);
+                ImGui::EndMenu();
+            }
+            ImGui::Separator();
+            bool running = audioOutput.running();
+            for (const AudioOutput::Device& device : audioOutput.devices()) {
+                bool isSelected = running && active.device == (int)device.id;
+                if (ImGui::MenuItem(device.name.c_str(), nullptr, isSelected) && !isSelected) {
+                    AudioOutput::Settings settings = active;
+                    settings.device = (int)device.id;
+                    audioOutput.Open(settings);
+                }
+            }
+            ImGui::Separator();
+            if (audioOutput.switching()) {
+                ImGui::TextDisabled("Switching...");
+            } else {
+                audioOutput.SetProcessingLatency((unsigned int)limiter.latency());
+                std::string status = audioOutput.status();
+                if (!status.empty()) ImGui::TextDisabled("%s", status.c_str());
+            }
+            ImGui::TextDisabled("Tracks render on %zu threads", renderPool.threadCount());
+            if (audioThreadReport.ready.load(std::memory_order_acquire)) {
+                ImGui::TextDisabled("Audio thread: %s", DescribeSchedule(audioThreadReport.schedule).c_str());
+                if (audioThreadReport.error) ImGui::TextDisabled("  setup failed: %s", std::strerror(audioThreadReport.error));
+            }
+            for (size_t i = 0; i + 1 < renderPool.threadCount(); ++i) {
+                const ThreadReport& report = renderThreadReports[i];
+                if (!report.ready.load(std::memory_order_acquire)) continue;
+                ImGui::TextDisabled("Render thread %zu: %s", i + 1, DescribeSchedule(report.schedule).c_str());
+                if (report.error) ImGui::TextDisabled("  setup failed: %s", std::strerror(report.error));
+            }
+            if (!memoryLockStatus.empty()) ImGui::TextDisabled("%s", memoryLockStatus.c_str());
+            if (AllocationGuardEnabled()) {
+                ImGui::TextDisabled("Allocations on the audio path: %llu", (unsigned long long)RealtimeAllocations());
             }
             ImGui::EndMenu();
         }
@@ -341,6 +1513,21 @@ void ShowMenuBar() {
             if (ImGui::MenuItem("Spectrogram: Linear Scale", nullptr, isLinear)) {
                 gSpectrogramScale = SpectrogramScale::Linear;
             }
+            bool isMel = (gSpectrogramScale == SpectrogramScale::Mel);
+            if (ImGui::MenuItem("Spectrogram: Mel Scale", nullptr, isMel)) {
+                gSpectrogramScale = SpectrogramScale::Mel;
+            }
+            bool isDb = (gSpectrogramAmplitude == SpectrogramAmplitude::Decibel);
+            if (ImGui::MenuItem("Spectrogram: dB Amplitude", nullptr, isDb)) {
+                gSpectrogramAmplitude = isDb ? SpectrogramAmplitude::Linear : SpectrogramAmplitude::Decibel;
+            }
+            if (isDb) {
+                ImGui::SliderFloat("dB Range", &gSpectrogramDbRange, 20.0f, 120.0f, "%.0f dB");
+            }
+            bool isInferno = (gSpectrogramColormap == SpectrogramColormap::Inferno);
+            if (ImGui::MenuItem("Spectrogram: Inferno Colormap", nullptr, isInferno)) {
+                gSpectrogramColormap = isInferno ? SpectrogramColormap::Grayscale : SpectrogramColormap::Inferno;
+            }
             ImGui::Separator();
             bool anchorZero = gWaveformAnchorZero;
             if (ImGui::MenuItem("Waveform: Anchor at Zero-Crossing", nullptr, anchorZero)) {
@@ -356,19 +1543,115 @@ void ShowMenuBar() {
             if (ImGui::MenuItem("Waveform: Triggered Capture", nullptr, !gWaveformContinuous)) {
                 gWaveformContinuous = false;
             }
+            ImGui::Separator();
+            ImGui::MenuItem("Throttle Redraw When Idle", nullptr, &gIdleThrottling);
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
     }
 }
 
+// Lock editor for one step: a checkbox per parameter turns its lock on, the
+// slider sets the locked value. Unlocked parameters show the track's value.
+void ShowStepLocks(size_t track, int step) {
+    ImGui::Separator();
+    ImGui::Text("Parameter locks: %s, step %d", model_names[track].c_str(), step + 1);
+    static std::string lockStatus;
+    std::lock_guard<std::mutex> lock(param_mutex);
+    DrumModel& model = *models[track];
+    for (size_t id = 0; id < model.getParameterCount(); ++id) {
+        const ParamDesc& d = model.getParameterDesc(id);
+        float value;
+        bool locked = sequencer.lock(track, step, (uint16_t)id, &value);
+        if (!locked) value = model.getParameter(id);
+        ImGui::PushID((int)id);
+        if (ImGui::Checkbox("##locked", &locked)) {
+            lockStatus.clear();
+            if (!locked) sequencer.ClearLock(track, step, (uint16_t)id);
+            else if (!sequencer.SetLock(track, step, (uint16_t)id, value)) {
+                lockStatus = "At most " + std::to_string(kMaxStepLocks) + " locks per step";
+            }
+        }
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!locked);
+        ImGuiSliderFlags flags = d.curve == ParamCurve::Log ? ImGuiSliderFlags_Logarithmic : 0;
+        if (ImGui::SliderFloat(d.name, &value, d.min, d.max, "%.3f", flags) && locked) {
+            sequencer.SetLock(track, step, (uint16_t)id, d.Clamp(value));
+        }
+        ImGui::EndDisabled();
+        ImGui::PopID();
+    }
+    if (!lockStatus.empty()) ImGui::TextWrapped("%s", lockStatus.c_str());
+}
+
+// Step grid, 16 steps per page; the playing step is highlighted, steps with
+// parameter locks are tinted. Right-click a step to edit its locks.
+void ShowSequencerWindow() {
+    if (!ImGui::Begin("Sequencer")) {
+        ImGui::End();
+        return;
+    }
+    if (ImGui::Button(sequencer.isRunning() ? "Stop" : "Play")) {
+        if (sequencer.isRunning()) sequencer.Stop();
+        else sequencer.Start();
+    }
+    float bpm = sequencer.tempo();
+    if (ImGui::DragFloat("Tempo (BPM)", &bpm, 0.1f, 20.0f, 300.0f, "%.1f")) sequencer.SetTempo(bpm);
+    float swing = sequencer.swing() * 100.0f;
+    if (ImGui::SliderFloat("Swing", &swing, 50.0f, 80.0f, "%.0f%%")) sequencer.SetSwing(swing / 100.0f);
+    int length = sequencer.length();
+    if (ImGui::SliderInt("Length", &length, 1, StepSequencer::kMaxSteps)) sequencer.SetLength(length);
+    static int page = 0;
+    int pages = (sequencer.length() + 15) / 16;
+    if (pages > 1) ImGui::SliderInt("Page", &page, 0, pages - 1);
+    page = std::max(0, std::min(page, pages - 1));
+
+    static int lockTrack = -1, lockStep = -1;
+    int current = sequencer.currentStep();
+    int first = page * 16;
+    int last = std::min(sequencer.length(), first + 16);
+    for (size_t t = 0; t < model_names.size() && t < MAX_TRACKS; ++t) {
+        ImGui::PushID((int)t);
+        for (int step = first; step < last; ++step) {
+            if (step > first) ImGui::SameLine(0.0f, step % 4 == 0 ? 8.0f : 2.0f);
+            ImGui::PushID(step);
+            bool on = sequencer.step(t, step);
+            bool tinted = true;
+            if (step == current) ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.9f, 0.6f, 0.1f, 0.8f));
+            else if ((int)t == lockTrack && step == lockStep) ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.2f, 0.7f, 0.3f, 0.8f));
+            else if (sequencer.locks(t, step).count) ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.2f, 0.4f, 0.9f, 0.6f));
+            else tinted = false;
+            if (ImGui::Checkbox("##step", &on)) sequencer.SetStep(t, step, on);
+            if (ImGui::IsItemClicked(1)) {
+                lockTrack = (int)t;
+                lockStep = step;
+            }
+            if (tinted) ImGui::PopStyleColor();
+            ImGui::PopID();
+        }
+        ImGui::SameLine();
+        ImGui::Text("%s", model_names[t].c_str());
+        ImGui::PopID();
+    }
+    if (lockTrack >= 0 && lockTrack < (int)model_names.size() && lockStep < sequencer.length()) {
+        ShowStepLocks(lockTrack, lockStep);
+    } else {
+        ImGui::TextDisabled("Right-click a step to edit its parameter locks");
+    }
+    ImGui::End();
+}
+
 void ShowWaveformWindow() {
-    ImGui::Begin("Waveform Display", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
-    std::vector<float> samples;
-    {
-        std::lock_guard<std::mutex> lock(waveformMutex);
-        samples.assign(waveformBuffer.begin(), waveformBuffer.end());
+    DrainWaveformChunks();
+    // Collapsed or fully clipped: skip the pyramid queries entirely
+    if (!ImGui::Begin("Waveform Display", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse)) {
+        ImGui::End();
+        return;
     }
+    // Only the window bounds are read here; the samples stay in the pyramid
+    uint64_t windowEnd = waveformPyramid.total();
+    uint64_t windowStart = windowEnd > WAVEFORM_BUFFER_SIZE ? windowEnd - WAVEFORM_BUFFER_SIZE : 0;
+    size_t numAvailable = (size_t)(windowEnd - windowStart);
     ImVec2 avail = ImGui::GetContentRegionAvail();
     // --- Improved slider/scrollbar height calculation ---
     float totalSliderHeight = 0.0f;
@@ -377,11 +1660,11 @@ void ShowWaveformWindow() {
     static float scroll = 0.0f;
     size_t numSamplesToShow = 0;
     size_t maxScroll = 0;
-    if (!samples.empty()) {
+    if (numAvailable > 0) {
         totalSliderHeight += ImGui::GetFrameHeightWithSpacing(); // Time Scale always visible if samples exist
         numSamplesToShow = (size_t)(timeScale * SAMPLE_RATE);
-        numSamplesToShow = std::min(numSamplesToShow, samples.size());
-        maxScroll = samples.size() > numSamplesToShow ? samples.size() - numSamplesToShow : 0;
+        numSamplesToShow = std::min(numSamplesToShow, numAvailable);
+        maxScroll = numAvailable > numSamplesToShow ? numAvailable - numSamplesToShow : 0;
         if (maxScroll > 0) {
             totalSliderHeight += ImGui::GetFrameHeightWithSpacing(); // Scrollbar only if needed
         }
@@ -389,7 +1672,7 @@ void ShowWaveformWindow() {
     ImVec2 plotAvail = avail;
     plotAvail.y = std::max(0.0f, avail.y - totalSliderHeight - 8.0f); // 8px padding
     // --- Time scale and scrollbar additions ---
-    if (!samples.empty()) {
+    if (numAvailable > 0) {
         ImGui::SliderFloat("Time Scale (s)", &timeScale, 0.001f, 1.0f, "%.3fs", ImGuiSliderFlags_Logarithmic);
         if (maxScroll > 0) {
             ImGui::SliderFloat("Scroll", &scroll, 0.0f, (float)maxScroll, "%.0f");
@@ -398,24 +1681,57 @@ void ShowWaveformWindow() {
         }
     }
     size_t scrollIdx = (size_t)scroll;
-    if (!samples.empty()) {
-        // Always apply anchor and scroll before plotting
-        size_t anchorOffset = 0;
-        if (gWaveformAnchorZero) {
-            for (size_t i = 1; i < samples.size(); ++i) {
-                if ((samples[i - 1] <= 0.0f && samples[i] > 0.0f) || (samples[i - 1] >= 0.0f && samples[i] < 0.0f)) {
-                    anchorOffset = i;
-                    break;
-                }
+    size_t columns = (size_t)std::max(0.0f, plotAvail.x);
+    if (numAvailable > 0 && columns > 0 && plotAvail.y >= 1.0f) {
+        static std::vector<float> colMin, colMax;
+        static std::vector<ImVec2> points;
+        size_t plotCount = 0;
+        {
+            // Always apply anchor and scroll before plotting
+            uint64_t begin = windowStart;
+            if (gWaveformAnchorZero) {
+                uint64_t crossing = waveformPyramid.FindZeroCrossing(windowStart + 1, windowEnd);
+                if (crossing != windowEnd) begin = crossing;
+            }
+            uint64_t startIdx = std::min(begin + scrollIdx, windowEnd);
+            uint64_t endIdx = std::min(startIdx + numSamplesToShow, windowEnd);
+            plotCount = (size_t)(endIdx - startIdx);
+            if (plotCount > columns) {
+                colMin.resize(columns);
+                colMax.resize(columns);
+                waveformPyramid.Query(startIdx, plotCount, columns, colMin.data(), colMax.data());
+            } else {
+                points.resize(plotCount);
+                for (size_t k = 0; k < plotCount; ++k) points[k].y = waveformPyramid.Sample(startIdx + k);
             }
         }
-        size_t startIdx = anchorOffset + scrollIdx;
-        if (startIdx > samples.size()) startIdx = samples.size();
-        size_t endIdx = std::min(startIdx + numSamplesToShow, samples.size());
-        int plotCount = (int)(endIdx - startIdx);
-        if (plotCount > 0) {
-            const float* plotData = samples.data() + startIdx;
-            ImGui::PlotLines("Waveform", plotData, plotCount, 0, nullptr, -1.0f, 1.0f, plotAvail);
+        ImVec2 p0 = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton("##waveform", plotAvail);
+        ImVec2 p1(p0.x + plotAvail.x, p0.y + plotAvail.y);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        drawList->AddRectFilled(p0, p1, ImGui::GetColorU32(ImGuiCol_FrameBg));
+        ImU32 lineCol = ImGui::GetColorU32(ImGuiCol_PlotLines);
+        auto toY = [&](float v) {
+            v = std::max(-1.0f, std::min(1.0f, v));
+            return p0.y + (1.0f - (v + 1.0f) * 0.5f) * plotAvail.y;
+        };
+        if (plotCount > columns) {
+            // One vertical min/max stroke per pixel column, joined to its neighbour
+            float prevMin = colMin[0], prevMax = colMax[0];
+            for (size_t c = 0; c < columns; ++c) {
+                float lo = std::min(colMin[c], prevMax);
+                float hi = std::max(colMax[c], prevMin);
+                float x = p0.x + (float)c + 0.5f;
+                drawList->AddLine(ImVec2(x, toY(hi)), ImVec2(x, toY(lo) + 1.0f), lineCol);
+                prevMin = colMin[c];
+                prevMax = colMax[c];
+            }
+        } else if (plotCount > 1) {
+            float dx = plotAvail.x / (float)(plotCount - 1);
+            for (size_t k = 0; k < plotCount; ++k) {
+                points[k] = ImVec2(p0.x + dx * (float)k, toY(points[k].y));
+            }
+            drawList->AddPolyline(points.data(), (int)plotCount, lineCol, 0, 1.0f);
         } else {
             ImGui::Text("No waveform data.");
         }
@@ -425,98 +1741,199 @@ void ShowWaveformWindow() {
     ImGui::End();
 }
 
-void ShowWaterfallWindow() {
-    static std::vector<unsigned char> image(WATERFALL_HISTORY * (FFT_SIZE/2) * 3, 0);
-    static GLuint waterfallTex = 0;
-    // Compute FFT and update waterfall
-    std::vector<float> fftBuf;
-    {
-        std::lock_guard<std::mutex> lock(fftMutex);
-        if (fftInputBuffer.size() == FFT_SIZE) {
-            computeFFT(fftInputBuffer, waterfallHistory[waterfallPos]);
-            waterfallPos = (waterfallPos + 1) % WATERFALL_HISTORY;
-        }
+// Re-allocate the offscreen color target when the waterfall window is resized
+void ResizeWaterfallTarget(int w, int h) {
+    if (w == wfFboW && h == wfFboH) return;
+    wfFboW = w;
+    wfFboH = h;
+    glBindTexture(GL_TEXTURE_2D, wfFboTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+}
+
+// Polynomial fit of matplotlib's inferno colormap, as in the shader
+void Inferno(float t, float rgb[3]) {
+    static const float c[7][3] = {
+        {0.0002189403691192265f, 0.001651004631001012f, -0.01948089843709184f},
+        {0.1065134194856116f, 0.5639564367884091f, 3.932712388889277f},
+        {11.60249308247187f, -3.972853965665698f, -15.9423941062914f},
+        {-41.70399613139459f, 17.43639888205313f, 44.35414519872813f},
+        {77.162935699427f, -33.40235894210092f, -81.80730925738993f},
+        {-71.31942824499214f, 32.62606426397723f, 73.20951985803202f},
+        {25.13112622477341f, -12.24266895238567f, -23.07032500287172f},
+    };
+    for (int k = 0; k < 3; ++k) {
+        float v = c[6][k];
+        for (int i = 5; i >= 0; --i) v = c[i][k] + t * v;
+        rgb[k] = std::min(1.0f, std::max(0.0f, v));
+    }
+}
+
+// CPU fallback of the spectrogram shader: the same frequency warping,
+// amplitude scaling and colormap, newest frame on the left. Repaints only
+// when a frame arrived or a setting changed.
+void PaintWaterfallImage(bool newFrame) {
+    static SpectrogramScale paintedScale;
+    static SpectrogramAmplitude paintedAmplitude;
+    static SpectrogramColormap paintedColormap;
+    static float paintedDbRange = -1.0f;
+    if (!newFrame && paintedScale == gSpectrogramScale && paintedAmplitude == gSpectrogramAmplitude &&
+        paintedColormap == gSpectrogramColormap && paintedDbRange == gSpectrogramDbRange) {
+        return;
     }
-    // Exponential mapping for y axis (log-frequency)
+    paintedScale = gSpectrogramScale;
+    paintedAmplitude = gSpectrogramAmplitude;
+    paintedColormap = gSpectrogramColormap;
+    paintedDbRange = gSpectrogramDbRange;
+
     size_t nBins = FFT_SIZE/2;
-    // Choose mapping based on gSpectrogramScale
-    if (gSpectrogramScale == SpectrogramScale::Log) {
-        float minFreq = 1.0f; // Avoid log(0)
-        float maxFreq = (float)(nBins - 1);
-        float logMin = log10(minFreq);
-        float logMax = log10(maxFreq);
-        for (size_t x = 0; x < WATERFALL_HISTORY; ++x) {
-            size_t col = (waterfallPos + WATERFALL_HISTORY - 1 - x) % WATERFALL_HISTORY;
-            for (size_t y = 0; y < nBins; ++y) {
-                float y_norm = (float)y / (float)(nBins - 1);
-                float logF = logMin + y_norm * (logMax - logMin);
-                float bin_idx = pow(10.0f, logF);
-                if (bin_idx < 0.0f) bin_idx = 0.0f;
-                if (bin_idx > maxFreq) bin_idx = maxFreq;
-                size_t bin0 = (size_t)bin_idx;
-                size_t bin1 = std::min(bin0 + 1, nBins - 1);
-                float frac = bin_idx - bin0;
-                float v0 = waterfallHistory[col][bin0];
-                float v1 = waterfallHistory[col][bin1];
-                float v = v0 * (1.0f - frac) + v1 * frac;
-                v = std::min(1.0f, v * 20.0f);
-                unsigned char c = (unsigned char)(v * 255);
-                size_t fy = (nBins - 1) - y;
-                size_t idx = 3 * (fy * WATERFALL_HISTORY + x);
-                image[idx + 0] = c;
-                image[idx + 1] = c;
-                image[idx + 2] = c;
-            }
-        }
-    } else { // Linear
+    float nyquist = SAMPLE_RATE * 0.5f;
+    auto mel = [](float f) { return 2595.0f * std::log10(1.0f + f / 700.0f); };
+    for (size_t y = 0; y < nBins; ++y) {
+        // Top row is the highest frequency
+        float v = (float)(nBins - 1 - y) / (float)(nBins - 1);
+        float bin;
+        if (gSpectrogramScale == SpectrogramScale::Log) {
+            bin = std::pow(10.0f, v * std::log10((float)nBins - 1.0f));
+        } else if (gSpectrogramScale == SpectrogramScale::Mel) {
+            float f = 700.0f * (std::pow(10.0f, v * mel(nyquist) / 2595.0f) - 1.0f);
+            bin = f / nyquist * nBins;
+        } else {
+            bin = v * (nBins - 1);
+        }
+        bin = std::min(std::max(bin, 0.0f), (float)(nBins - 1));
+        size_t bin0 = (size_t)bin;
+        size_t bin1 = std::min(bin0 + 1, nBins - 1);
+        float frac = bin - bin0;
+        unsigned char* row = waterfallImage.data() + 3 * y * WATERFALL_HISTORY;
         for (size_t x = 0; x < WATERFALL_HISTORY; ++x) {
-            size_t col = (waterfallPos + WATERFALL_HISTORY - 1 - x) % WATERFALL_HISTORY;
-            for (size_t y = 0; y < nBins; ++y) {
-                size_t fy = (nBins - 1) - y;
-                float v = std::min(1.0f, waterfallHistory[col][y] * 20.0f);
-                unsigned char c = (unsigned char)(v * 255);
-                size_t idx = 3 * (fy * WATERFALL_HISTORY + x);
-                image[idx + 0] = c;
-                image[idx + 1] = c;
-                image[idx + 2] = c;
-            }
-        }
-    }
-    // Create or update OpenGL texture (width=WATERFALL_HISTORY, height=FFT_SIZE/2)
-    if (!waterfallTex) {
-        glGenTextures(1, &waterfallTex);
-        glBindTexture(GL_TEXTURE_2D, waterfallTex);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WATERFALL_HISTORY, nBins, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data());
-    } else {
-        glBindTexture(GL_TEXTURE_2D, waterfallTex);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, WATERFALL_HISTORY, nBins, GL_RGB, GL_UNSIGNED_BYTE, image.data());
+            const float* column = waterfallHistory.data() + ((waterfallPos + WATERFALL_HISTORY - 1 - x) % WATERFALL_HISTORY) * nBins;
+            float mag = column[bin0] + (column[bin1] - column[bin0]) * frac;
+            float level;
+            if (gSpectrogramAmplitude == SpectrogramAmplitude::Decibel) {
+                float db = 20.0f * std::log10(std::max(mag, 1e-9f) / 0.5f);
+                level = std::min(std::max(1.0f + db / gSpectrogramDbRange, 0.0f), 1.0f);
+            } else {
+                level = std::min(mag * 20.0f, 1.0f);
+            }
+            float rgb[3] = {level, level, level};
+            if (gSpectrogramColormap == SpectrogramColormap::Inferno) Inferno(level, rgb);
+            for (int k = 0; k < 3; ++k) row[3 * x + k] = (unsigned char)(rgb[k] * 255.0f);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, wfCpuTex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, WATERFALL_HISTORY, (GLsizei)nBins, GL_RGB, GL_UNSIGNED_BYTE, waterfallImage.data());
+}
+
+void ShowWaterfallWindow(bool idle) {
+    // Collapsed or fully clipped: no FFT, no texture upload, no offscreen pass
+    if (!ImGui::Begin("Waterfall (Spectrogram)", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse)) {
+        ImGui::End();
+        return;
+    }
+    size_t nBins = FFT_SIZE/2;
+    // Compute FFT and stream the new frame into the ring texture. While idle
+    // the input is silence, so the history is left as is.
+    bool newFrame = !idle && fftTap.ReadLatest(fftFrame.data(), FFT_SIZE);
+    if (newFrame) {
+        computeFFT(fftFrame, waterfallColumn);
+        if (wfGpu) {
+            glBindTexture(GL_TEXTURE_2D, wfRingTex);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (GLint)waterfallPos, (GLsizei)nBins, 1, GL_RED, GL_FLOAT, waterfallColumn.data());
+        } else {
+            std::copy(waterfallColumn.begin(), waterfallColumn.end(), waterfallHistory.begin() + waterfallPos * nBins);
+        }
+        waterfallPos = (waterfallPos + 1) % WATERFALL_HISTORY;
     }
-    ImGui::Begin("Waterfall (Spectrogram)", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
     ImVec2 avail = ImGui::GetContentRegionAvail();
-    // Fill the window completely, even if aspect ratio is not preserved
-    ImGui::Image((void*)(intptr_t)waterfallTex, avail);
+    if (!wfGpu) {
+        PaintWaterfallImage(newFrame);
+        ImGui::Image((void*)(intptr_t)wfCpuTex, avail);
+        ImGui::End();
+        return;
+    }
+    int w = std::max(1, (int)avail.x);
+    int h = std::max(1, (int)avail.y);
+    ResizeWaterfallTarget(w, h);
+
+    // Render the colormapped spectrogram into the offscreen target
+    GLint prevFbo = 0;
+    GLint prevViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, wfFbo);
+    glViewport(0, 0, w, h);
+    glDisable(GL_BLEND);
+    glUseProgram(wfShader);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, wfRingTex);
+    glUniform1i(wfRingTexLoc, 0);
+    size_t newest = (waterfallPos + WATERFALL_HISTORY - 1) % WATERFALL_HISTORY;
+    glUniform1f(wfNewestRowLoc, ((float)newest + 0.5f) / (float)WATERFALL_HISTORY);
+    glUniform1f(wfHistoryRowsLoc, (float)WATERFALL_HISTORY);
+    glUniform1f(wfNyquistLoc, SAMPLE_RATE * 0.5f);
+    glUniform1i(wfScaleModeLoc, (int)gSpectrogramScale);
+    glUniform1i(wfAmpModeLoc, (int)gSpectrogramAmplitude);
+    glUniform1f(wfDbRangeLoc, gSpectrogramDbRange);
+    glUniform1i(wfColormapLoc, (int)gSpectrogramColormap);
+    glBindVertexArray(bgVao);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prevFbo);
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+
+    // Fill the window completely; GL textures are bottom-up, so flip v
+    ImGui::Image((void*)(intptr_t)wfFboTex, avail, ImVec2(0, 1), ImVec2(1, 0));
     ImGui::End();
 }
 
-void InitBackgroundShader() {
-    GLint status;
-    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &bgVertexShaderSrc, nullptr);
-    glCompileShader(vs);
-    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &bgFragmentShaderSrc, nullptr);
-    glCompileShader(fs);
-    bgShader = glCreateProgram();
-    glAttachShader(bgShader, vs);
-    glAttachShader(bgShader, fs);
-    glBindAttribLocation(bgShader, 0, "pos");
-    glLinkProgram(bgShader);
+// Logs the info log of a failed compile; returns 0 then
+GLuint CompileShader(GLenum type, const char* src, const char* what) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+    GLint status = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (!status) {
+        char log[1024] = "";
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << what << " shader compile failed: " << log << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// 0 when either shader does not compile or the program does not link
+GLuint BuildShaderProgram(const char* vsSrc, const char* fsSrc) {
+    GLuint vs = CompileShader(GL_VERTEX_SHADER, vsSrc, "Vertex");
+    GLuint fs = CompileShader(GL_FRAGMENT_SHADER, fsSrc, "Fragment");
+    if (!vs || !fs) {
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glBindAttribLocation(program, 0, "pos");
+    glLinkProgram(program);
     glDeleteShader(vs);
     glDeleteShader(fs);
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (!status) {
+        char log[1024] = "";
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        std::cerr << "Shader program link failed: " << log << "\n";
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void InitBackgroundShader() {
+    bgShader = BuildShaderProgram(bgVertexShaderSrc, bgFragmentShaderSrc);
     float quad[8] = { -1, -1, 1, -1, 1, 1, -1, 1 };
     glGenVertexArrays(1, &bgVao);
     glGenBuffers(1, &bgVbo);
@@ -538,27 +1955,77 @@ void InitBackgroundShader() {
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 }
 
+void InitWaterfallCpu() {
+    std::cerr << "Drawing the spectrogram on the CPU\n";
+    wfGpu = false;
+    waterfallHistory.assign(WATERFALL_HISTORY * (FFT_SIZE/2), 0.0f);
+    waterfallImage.assign(3 * WATERFALL_HISTORY * (FFT_SIZE/2), 0);
+    glGenTextures(1, &wfCpuTex);
+    glBindTexture(GL_TEXTURE_2D, wfCpuTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WATERFALL_HISTORY, FFT_SIZE/2, 0, GL_RGB, GL_UNSIGNED_BYTE, waterfallImage.data());
+}
+
+// Shares the fullscreen quad from InitBackgroundShader, so call it afterwards
+void InitWaterfallShader() {
+    wfShader = BuildShaderProgram(bgVertexShaderSrc, wfFragmentShaderSrc);
+    if (!wfShader) {
+        InitWaterfallCpu();
+        return;
+    }
+    wfRingTexLoc = glGetUniformLocation(wfShader, "ringTex");
+    wfNewestRowLoc = glGetUniformLocation(wfShader, "newestRow");
+    wfHistoryRowsLoc = glGetUniformLocation(wfShader, "historyRows");
+    wfNyquistLoc = glGetUniformLocation(wfShader, "nyquist");
+    wfScaleModeLoc = glGetUniformLocation(wfShader, "scaleMode");
+    wfAmpModeLoc = glGetUniformLocation(wfShader, "ampMode");
+    wfDbRangeLoc = glGetUniformLocation(wfShader, "dbRange");
+    wfColormapLoc = glGetUniformLocation(wfShader, "colormap");
+    // Ring texture of raw magnitudes: width = bins, height = history frames
+    std::vector<float> zeros((FFT_SIZE/2) * WATERFALL_HISTORY, 0.0f);
+    glGenTextures(1, &wfRingTex);
+    glBindTexture(GL_TEXTURE_2D, wfRingTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, FFT_SIZE/2, WATERFALL_HISTORY, 0, GL_RED, GL_FLOAT, zeros.data());
+    // Offscreen target shown through ImGui::Image
+    glGenTextures(1, &wfFboTex);
+    glBindTexture(GL_TEXTURE_2D, wfFboTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    ResizeWaterfallTarget(1, 1);
+    glGenFramebuffers(1, &wfFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, wfFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, wfFboTex, 0);
+    wfGpu = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!wfGpu) {
+        std::cerr << "Waterfall framebuffer incomplete\n";
+        InitWaterfallCpu();
+    }
+}
+
 // Helper to upload FFT data to 1D texture
 void UploadFftTexture(const std::vector<float>& fftBins) {
     glBindTexture(GL_TEXTURE_1D, gFftTex);
     glTexImage1D(GL_TEXTURE_1D, 0, GL_R32F, (GLsizei)fftBins.size(), 0, GL_RED, GL_FLOAT, fftBins.data());
 }
 
-float ComputeWaveformLoudness() {
-    std::lock_guard<std::mutex> lock(waveformMutex);
-    float sum = 0.0f;
-    for (float s : waveformBuffer) sum += s * s;
-    return waveformBuffer.empty() ? 0.0f : sqrtf(sum / waveformBuffer.size());
-}
-
-void RenderAnimatedBackground(float loudness, float time) {
-    // Prepare FFT data for shader
-    std::vector<float> fftBins(64, 0.0f);
-    {
-        std::lock_guard<std::mutex> lock(fftMutex);
-        if (!fftInputBuffer.empty()) {
+void RenderAnimatedBackground(float loudness, float time, bool idle) {
+    if (!bgShader) return; // failed to build: plain clear colour
+    // Prepare FFT data for shader; while idle the last upload is kept
+    if (!idle) {
+        std::vector<float> fftBins(64, 0.0f);
+        if (fftTap.ReadLatest(fftFrame.data(), FFT_SIZE)) {
             std::vector<float> fftTmp;
-            computeFFT(fftInputBuffer, fftTmp);
+            computeFFT(fftFrame, fftTmp);
             // Downsample or average to 64 bins
             for (int i = 0; i < 64; ++i) {
                 float sum = 0.0f;
@@ -568,8 +2035,8 @@ void RenderAnimatedBackground(float loudness, float time) {
                 fftBins[i] = sum / std::max(1, end - start);
             }
         }
+        UploadFftTexture(fftBins);
     }
-    UploadFftTexture(fftBins);
     int width, height;
     glfwGetFramebufferSize(glfwGetCurrentContext(), &width, &height);
     glViewport(0, 0, width, height);
@@ -592,37 +2059,173 @@ void RenderAnimatedBackground(float loudness, float time) {
     glDisable(GL_BLEND);
 }
 
-void EnumerateAudioDevices() {
-    audioDeviceNames.clear();
-    audioDeviceIds.clear();
-    unsigned int nDevices = dac.getDeviceCount();
-    for (unsigned int i = 0; i < nDevices; ++i) {
-        RtAudio::DeviceInfo info = dac.getDeviceInfo(i);
-        if (info.probed && info.outputChannels > 0) {
-            audioDeviceNames.push_back(info.name);
-            audioDeviceIds.push_back(i);
+// Installed before ImGui's GLFW backend, which chains to these, so every
+// input event refreshes the activity timestamp used by idle throttling
+void MarkInputActivity() { gLastInputTime = glfwGetTime(); }
+
+// Pads trigger straight from the GLFW key callback, which runs as soon as
+// the main loop services the event rather than at the next frame
+void PadKeyCallback(GLFWwindow*, int key, int, int action, int mods) {
+    MarkInputActivity();
+    if (action != GLFW_PRESS) return; // no auto-repeat
+    if (mods & (GLFW_MOD_CONTROL | GLFW_MOD_SUPER | GLFW_MOD_ALT)) return;
+    if (ImGui::GetIO().WantTextInput) return;
+    if (key == GLFW_KEY_SPACE) {
+        RequestTrigger(selected_model_index);
+        return;
+    }
+    for (size_t t = 0; t < MAX_TRACKS && t < models.size(); ++t) {
+        if (kPadKeys[t] == key) {
+            RequestTrigger(t);
+            return;
         }
     }
 }
 
+void InstallActivityCallbacks(GLFWwindow* window) {
+    glfwSetCursorPosCallback(window, [](GLFWwindow*, double, double) { MarkInputActivity(); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow*, int, int, int) { MarkInputActivity(); });
+    glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { MarkInputActivity(); });
+    glfwSetKeyCallback(window, PadKeyCallback);
+    glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { MarkInputActivity(); });
+    glfwSetWindowSizeCallback(window, [](GLFWwindow*, int, int) { MarkInputActivity(); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { MarkInputActivity(); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { MarkInputActivity(); });
+}
+
+// Render helpers run at the audio thread's priority: the callback waits
+// for the tracks they have taken
+void SetUpRenderThread(size_t helper) {
+    ThreadReport& report = renderThreadReports[helper];
+    const std::vector<int>& cpus = engineOptions.renderCpus;
+    report.error = ConfigureCurrentThread(engineOptions.rtPriority, cpus.empty() ? -1 : cpus[helper % cpus.size()]);
+    PrefaultStack();
+    report.schedule = CurrentThreadSchedule();
+    report.ready.store(true, std::memory_order_release);
+}
+
+// Prints each thread's scheduling once it is known, the audio thread's
+// again for every new stream
+void LogThreadReports() {
+    static unsigned int audioLogged = 0;
+    static bool renderLogged[MAX_TRACKS] = {};
+    auto log = [](const char* name, const ThreadReport& report) {
+        std::cout << name << ": " << DescribeSchedule(report.schedule);
+        if (report.error) std::cout << " (setup failed: " << std::strerror(report.error) << ")";
+        std::cout << "\n";
+    };
+    unsigned int audioSetups = audioThreadSetups.load(std::memory_order_acquire);
+    if (audioLogged != audioSetups && audioThreadReport.ready.load(std::memory_order_acquire)) {
+        log("Audio thread", audioThreadReport);
+        audioLogged = audioSetups;
+    }
+    for (size_t i = 0; i + 1 < renderPool.threadCount(); ++i) {
+        if (renderLogged[i] || !renderThreadReports[i].ready.load(std::memory_order_acquire)) continue;
+        log(("Render thread " + std::to_string(i + 1)).c_str(), renderThreadReports[i]);
+        renderLogged[i] = true;
+    }
+}
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --rt-priority N      run the audio and render threads under SCHED_FIFO at priority N (1-99)\n"
+              << "  --audio-cpu N        pin the audio thread to CPU N\n"
+              << "  --render-cpus LIST   pin the render threads to these CPUs, e.g. 2,3,4\n"
+              << "  --render-threads N   render on N threads including the audio thread (default: one per core)\n"
+              << "  --mlock              lock the process in memory (needs a large enough ulimit -l)\n"
+              << "  --abort-on-allocation  abort when the audio path allocates (ALLOCATION_GUARD builds)\n"
+              << "  --audio-api NAME     audio API:";
+    std::vector<RtAudio::Api> apis;
+    RtAudio::getCompiledApi(apis);
+    for (RtAudio::Api api : apis) std::cerr << " " << RtAudio::getApiName(api);
+    std::cerr << "\n"
+              << "  --buffer-frames N    frames per period, 16-4096 (default 256)\n"
+              << "  --periods N          periods in the device buffer, 2-16 (default: the backend's)\n";
+}
+
+// False after --help or an invalid option, once the usage is printed
+bool ParseCommandLine(int argc, char* argv[]) {
+    auto number = [](const char* text, int min, int max, int* value) {
+        char* end;
+        long n = std::strtol(text, &end, 10);
+        if (end == text || *end || n < min || n > max) return false;
+        *value = (int)n;
+        return true;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (arg == "--mlock") {
+            engineOptions.lockMemory = true;
+        } else if (arg == "--abort-on-allocation") {
+            SetAllocationAbort(true);
+        } else if (arg == "--audio-api" && value) {
+            audioSettings.api = RtAudio::getCompiledApiByName(value);
+            ok = audioSettings.api != RtAudio::UNSPECIFIED;
+            ++i;
+        } else if (arg == "--buffer-frames" && value) {
+            int frames = 0;
+            ok = number(value, 16, 4096, &frames);
+            if (ok) audioSettings.bufferFrames = frames;
+            ++i;
+        } else if (arg == "--periods" && value) {
+            int periods = 0;
+            ok = number(value, 2, 16, &periods);
+            if (ok) audioSettings.periods = periods;
+            ++i;
+        } else if (arg == "--rt-priority" && value) {
+            ok = number(value, 1, 99, &engineOptions.rtPriority);
+            ++i;
+        } else if (arg == "--audio-cpu" && value) {
+            ok = number(value, 0, 1023, &engineOptions.audioCpu);
+            ++i;
+        } else if (arg == "--render-threads" && value) {
+            int threads = 0;
+            ok = number(value, 1, (int)MAX_TRACKS, &threads);
+            if (ok) engineOptions.renderThreads = threads;
+            ++i;
+        } else if (arg == "--render-cpus" && value) {
+            std::string list = value;
+            for (size_t pos = 0; ok && pos <= list.size();) {
+                size_t comma = std::min(list.find(',', pos), list.size());
+                int cpu = 0;
+                ok = number(list.substr(pos, comma - pos).c_str(), 0, 1023, &cpu);
+                if (ok) engineOptions.renderCpus.push_back(cpu);
+                pos = comma + 1;
+            }
+            ++i;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            if (arg != "--help" && arg != "-h") std::cerr << "Invalid option: " << arg << "\n";
+            PrintUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
-    models.push_back(std::make_shared<FmKickModel>()); model_names.push_back("Kick");
-    models.push_back(std::make_shared<FmSnareModel>()); model_names.push_back("Snare");
-    models.push_back(std::make_shared<FmTomModel>()); model_names.push_back("Tom");
-    models.push_back(std::make_shared<FmClapModel>()); model_names.push_back("Clap");
-    models.push_back(std::make_shared<FmRimshotModel>()); model_names.push_back("Rimshot");
-    models.push_back(std::make_shared<FmCowbellModel>()); model_names.push_back("Cowbell");
-    models.push_back(std::make_shared<FmCymbalModel>()); model_names.push_back("Cymbal");
-    models.push_back(std::make_shared<TRXBassDrum>()); model_names.push_back("TRX Bass Drum");
-    models.push_back(std::make_shared<TRXSnareDrum>()); model_names.push_back("TRX Snare Drum");
-    models.push_back(std::make_shared<TRXClaves>()); model_names.push_back("TRX Claves");
-    models.push_back(std::make_shared<TRXHiHat>()); model_names.push_back("TRX HiHat");
-
-    for (auto& model : models) model->Init();
+    if (!ParseCommandLine(argc, argv)) return 1;
+    if (engineOptions.lockMemory) {
+        std::string error;
+        memoryLockStatus = LockProcessMemory(&error) ? "Memory locked" : error;
+        std::cout << memoryLockStatus << "\n";
+    }
+    for (size_t t = 0; t < TrackCount(); ++t) model_names.push_back(TrackName(t));
+    StageKit(CreateDrumKit());
+    for (auto& meter : trackMeters) meter.Init(SAMPLE_RATE);
+    masterMeter.Init(SAMPLE_RATE);
+    limiter.Init(SAMPLE_RATE);
+    routedDelay.Init(AudioOutput::kMaxChannels - 2, limiter.maxLatency());
+    reverb.Init(SAMPLE_RATE);
+    for (TrackInsert& insert : trackInserts) insert.Init(SAMPLE_RATE);
+    delay.Init(SAMPLE_RATE);
 
     // Load last parameters at program start, or create with defaults if missing
     namespace fs = std::filesystem;
-    const char* param_file = "drum_params.txt";
     if (!fs::exists(param_file)) {
         std::ofstream ofs(param_file);
         ofs << "52.549 0.253 461.03 0.052 0.295 2.196 529.412 0.038 1 57 1\n";
@@ -637,38 +2240,33 @@ int main(int argc, char* argv[]) {
         ofs << "1410.78 200 0.017 0.5 0.211\n";
         ofs << "0.819 0.034 10112.7 1604.41 1 0.569\n";
     }
-    {
-        std::ifstream ifs(param_file);
-        if (ifs) {
-            std::lock_guard<std::mutex> lock(param_mutex);
-            for (const auto& model : models) {
-                model->loadParameters(ifs);
-            }
-        }
-    }
+    LoadParameters(param_file);
+    lastAutosaved = SnapshotParameters(); // nothing to autosave until an edit
+    for (const auto& model : models) trackParamCounts.push_back(model->getParameterCount());
+    paramSaver.SetWriteHook([](const std::string& path, const std::string& text) {
+        if (path != param_file) return;
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        paramFileText = text;
+    });
 
-    // Initialize RtAudio and enumerate devices
-    if (dac.getDeviceCount() < 1) {
-        std::cerr << "No audio devices found!\n";
-        return 1;
-    }
-    EnumerateAudioDevices();
-    // Select default output device
-    unsigned int defaultDeviceId = dac.getDefaultOutputDevice();
-    for (int i = 0; i < audioDeviceIds.size(); ++i) {
-        if (audioDeviceIds[i] == defaultDeviceId) {
-            selectedAudioDeviceIdx = i;
-            break;
-        }
+    if (fs::exists(bank_file)) {
+        std::string error;
+        if (!kitBank.Open(bank_file, &error)) std::cerr << error << "\n";
     }
-    // Open and start stream with selected device
-    RtAudio::StreamParameters parameters;
-    parameters.deviceId = audioDeviceIds[selectedAudioDeviceIdx];
-    parameters.nChannels = 2;
-    parameters.firstChannel = 0;
-    unsigned int bufferFrames = BUFFER_SIZE;
-    dac.openStream(&parameters, nullptr, RTAUDIO_FLOAT32, SAMPLE_RATE, &bufferFrames, &audioCallback, nullptr);
-    dac.startStream();
+
+    // One render thread per core by default, up to one per track
+    size_t renderThreads = engineOptions.renderThreads;
+    if (renderThreads == 0) renderThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), MAX_TRACKS);
+    renderPool.Start(renderThreads, &SetUpRenderThread);
+    // Fault in what the callback works on, so its first blocks do not page fault
+    PrefaultMemory(trackBuffers, sizeof(trackBuffers));
+    PrefaultMemory(recordChunk, sizeof(recordChunk));
+    PrefaultMemory(paramSmoothers, sizeof(paramSmoothers));
+    PrefaultMemory(&waveformChunks, sizeof(waveformChunks));
+    PrefaultMemory(&modMatrix, sizeof(modMatrix));
+    // Opens in the background; on failure the GUI still comes up and shows why
+    audioSettings.rtPriority = engineOptions.rtPriority;
+    audioOutput.Open(audioSettings);
 
     glfwInit();
     // Use OpenGL 3.2+ core profile
@@ -688,21 +2286,40 @@ int main(int argc, char* argv[]) {
         std::cerr << "Failed to initialize GLAD!\n";
         return -1;
     }
-    glfwSwapInterval(1);
+    // Frames are paced in the main loop by waiting on events, so input is
+    // serviced while waiting instead of being blocked behind a vsync swap
+    glfwSwapInterval(0);
     // Removed window maximization for smaller default size
     // glfwMaximizeWindow(window);
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
+    InstallActivityCallbacks(window);
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 150");
     LoadBackgroundTexture();
     InitBackgroundShader();
+    InitWaterfallShader();
 
     // Arrange ImGui windows on first frame
     static bool firstFrame = true;
+    bool idle = false;
+    double nextFrameTime = glfwGetTime();
     while (!glfwWindowShouldClose(window)) {
+        // Service events until the next frame is due; key callbacks fire as
+        // soon as their event arrives. Input while idle redraws right away.
+        double waitStart = glfwGetTime();
+        for (double now = waitStart; now < nextFrameTime; now = glfwGetTime()) {
+            glfwWaitEventsTimeout(nextFrameTime - now);
+            if (idle && gLastInputTime >= waitStart) break;
+        }
         glfwPollEvents();
+        double frameStart = glfwGetTime();
+        // Minimized: nothing to draw, just keep servicing events
+        if (glfwGetWindowAttrib(window, GLFW_ICONIFIED)) {
+            nextFrameTime = frameStart + IDLE_FRAME_INTERVAL;
+            continue;
+        }
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -710,7 +2327,7 @@ int main(int argc, char* argv[]) {
         if (firstFrame) {
             ImGuiIO& io = ImGui::GetIO();
             io.DisplaySize = ImVec2((float)winWidth, (float)winHeight);
-            // Arrange windows: Controls left, Waveform center, Waterfall right
+            // Arrange windows: Controls left, Waveform and Waterfall center, Sequencer right
             ImGui::SetNextWindowPos(ImVec2(20, 40), ImGuiCond_Always);
             ImGui::SetNextWindowSize(ImVec2(340, winHeight - 60), ImGuiCond_Always);
             ImGui::Begin("FM Drum Synth", nullptr, ImGuiWindowFlags_NoCollapse);
@@ -723,68 +2340,62 @@ int main(int argc, char* argv[]) {
             ImGui::SetNextWindowSize(ImVec2((winWidth-370)/2, winHeight/2-50), ImGuiCond_Always);
             ImGui::Begin("Waterfall (Spectrogram)", nullptr, ImGuiWindowFlags_NoCollapse);
             ImGui::End();
+            ImGui::SetNextWindowPos(ImVec2(380 + (winWidth-370)/2, 40), ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2((winWidth-370)/2 - 30, winHeight - 60), ImGuiCond_Always);
+            ImGui::Begin("Sequencer", nullptr, ImGuiWindowFlags_NoCollapse);
+            ImGui::End();
             firstFrame = false;
         }
 
-        // Hotkey: Ctrl+S to save, Ctrl+L to load, Space to trigger
+        // Hotkey: Ctrl+S to save, Ctrl+L to load (pads are handled in PadKeyCallback)
         ImGuiIO& io = ImGui::GetIO();
         bool ctrl = io.KeyCtrl;
         if (ctrl && ImGui::IsKeyPressed(ImGuiKey_S, false)) {
-            std::ofstream ofs("drum_params.txt");
-            if (ofs) {
-                std::lock_guard<std::mutex> lock(param_mutex);
-                for (const auto& model : models) {
-                    model->saveParameters(ofs);
-                }
-            }
+            SaveParameters(param_file);
         }
         if (ctrl && ImGui::IsKeyPressed(ImGuiKey_L, false)) {
-            std::ifstream ifs("drum_params.txt");
-            if (ifs) {
-                std::lock_guard<std::mutex> lock(param_mutex);
-                for (const auto& model : models) {
-                    model->loadParameters(ifs);
-                }
-            }
-        }
-        if (ImGui::IsKeyPressed(ImGuiKey_Space, false)) {
-            trigger_requested = true;
+            LoadParameters(param_file);
         }
 
         ShowMenuBar();
         ShowControls();
         ShowWaveformWindow();
-        ShowWaterfallWindow();
+        ShowWaterfallWindow(idle);
+        ShowSequencerWindow();
+        Autosave(frameStart);
+        kitExchange.CollectRetired();
+        AdoptReloadedKit();
+        SyncParameters();
+        LogThreadReports();
+        UpdateRenderCache();
 
         ImGui::Render();
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
         // Draw animated background after clearing, before ImGui
-        float loudness = ComputeWaveformLoudness();
+        float loudness = masterMeter.rms();
         float time = (float)glfwGetTime();
-        RenderAnimatedBackground(loudness, time);
+        RenderAnimatedBackground(loudness, time, idle);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
         glfwSwapBuffers(window);
 
-        // Handle audio device change
-        if (audioNeedsRestart) {
-            dac.stopStream();
-            dac.closeStream();
-            RtAudio::StreamParameters newParams;
-            newParams.deviceId = audioDeviceIds[selectedAudioDeviceIdx];
-            newParams.nChannels = 2;
-            newParams.firstChannel = 0;
-            unsigned int bufferFrames = BUFFER_SIZE;
-            dac.openStream(&newParams, nullptr, RTAUDIO_FLOAT32, SAMPLE_RATE, &bufferFrames, &audioCallback, nullptr);
-            dac.startStream();
-            audioNeedsRestart = false;
-        }
+        // Decide how the next frame is paced
+        bool sounding = masterMeter.peak() > SILENCE_THRESHOLD || gWaveformCaptureActive;
+        bool recentInput = glfwGetTime() - gLastInputTime < INPUT_SETTLE_TIME;
+        idle = gIdleThrottling && !sounding && !recentInput;
+        double frameInterval = idle ? IDLE_FRAME_INTERVAL : ACTIVE_FRAME_INTERVAL;
+        nextFrameTime = frameStart + frameInterval;
     }
 
     // Cleanup
-    dac.stopStream();
-    dac.closeStream();
+    paramWatcher.reset();
+    audioOutput.Close();
+    renderPool.Stop();
+    recorder.Stop();
+    if (RealtimeAllocations()) std::cerr << RealtimeAllocations() << " allocations on the audio path\n";
+    delete audioKit;
+    delete fadingKit;
     glfwDestroyWindow(window);
     glfwTerminate();
 
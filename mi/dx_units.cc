@@ -26,7 +26,7 @@
 //
 // Various conversion routines for DX7 patch data.
 
-#include "plaits/dsp/fm/dx_units.h"
+#include "dx_units.h"
 
 namespace plaits {
 
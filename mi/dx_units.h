@@ -29,13 +29,13 @@
 #ifndef PLAITS_DSP_DX_UNITS_H_
 #define PLAITS_DSP_DX_UNITS_H_
 
-#include "stmlib/dsp/dsp.h"
-#include "stmlib/dsp/units.h"
+#include "dsp.h"
+#include "units.h"
 
 #include <algorithm>
 #include <cmath>
 
-#include "plaits/dsp/fm/patch.h"
+#include "patch.h"
 
 namespace plaits {
 
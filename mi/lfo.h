@@ -29,12 +29,12 @@
 #ifndef PLAITS_DSP_FM_LFO_H_
 #define PLAITS_DSP_FM_LFO_H_
 
-#include "stmlib/stmlib.h"
-#include "stmlib/utils/random.h"
+#include "stmlib.h"
+#include "random.h"
 
-#include "plaits/dsp/fm/dx_units.h"
-#include "plaits/dsp/fm/patch.h"
-#include "plaits/dsp/oscillator/sine_oscillator.h"
+#include "dx_units.h"
+#include "patch.h"
+#include "sine_oscillator.h"
 
 namespace plaits {
 
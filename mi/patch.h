@@ -29,7 +29,9 @@
 #ifndef PLAITS_DSP_FM_PATCH_H_
 #define PLAITS_DSP_FM_PATCH_H_
 
-#include "stmlib/stmlib.h"
+#include "stmlib.h"
+
+#include <algorithm>
 
 namespace plaits {
 